@@ -4,6 +4,10 @@
 outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
 dirs = {}
 dirs["root"] 			= os.realpath("../")
+-- realpath drops the trailing separator on some platforms, the paths below expect it
+if not dirs.root:endswith("/") then
+	dirs["root"] = dirs.root .. "/"
+end
 dirs["bin"]				= os.realpath(dirs.root .. "Bin/")
 dirs["temp"]			= os.realpath(dirs.root .. "Temp/")
 dirs["lib"]				= os.realpath(dirs.root .. "Lib/")
@@ -15,7 +19,8 @@ dirs["engine"]			= os.realpath(dirs.root .. "Source/Engine")
 dirs["settings"]		= os.realpath(dirs.root .. "Bin/settings/")
 dirs["shaders"]			= os.realpath(dirs.root .. "Bin/Shaders/")
 
-engine_settings = os.realpath(dirs.settings .. "/EngineSettings.json")
+-- Not realpath, that only resolves files that already exist on some platforms
+engine_settings = path.join(dirs.settings, "EngineSettings.json")
 
 
 -----------------------------------------------------------------------
@@ -79,7 +84,8 @@ function verify_or_create_settings(game_name)
 	else
 		settings = {
 			name = game_name,
-			assets_path = datadir
+			assets_path = datadir,
+			fixed_updates_per_second = 0
 		}
 	end
 
@@ -17,7 +17,8 @@ namespace DX
 			m_framesThisSecond(0),
 			m_qpcSecondCounter(0),
 			m_isFixedTimeStep(false),
-			m_targetElapsedTicks(TicksPerSecond / 60)
+			m_targetElapsedTicks(TicksPerSecond / 60),
+			m_maxUpdatesPerTick(0)
 		{
 			if (!QueryPerformanceFrequency(&m_qpcFrequency))
 			{
@@ -52,6 +53,21 @@ namespace DX
 		void SetTargetElapsedTicks(UINT64 targetElapsed)	{ m_targetElapsedTicks = targetElapsed; }
 		void SetTargetElapsedSeconds(double targetElapsed)	{ m_targetElapsedTicks = SecondsToTicks(targetElapsed); }
 
+		// Limit how many fixed updates one Tick may run, 0 means no limit. When the limit is hit the
+		// remaining whole steps are dropped so a slow frame can't cause an ever growing backlog.
+		void SetMaxUpdatesPerTick(UINT32 maxUpdates)		{ m_maxUpdatesPerTick = maxUpdates; }
+
+		// How far the clock is between the last fixed update and the next one, in [0, 1).
+		// Always 1 in variable timestep mode since the last update is exactly now.
+		double GetInterpolationAlpha() const
+		{
+			if (!m_isFixedTimeStep || m_targetElapsedTicks == 0)
+			{
+				return 1.0;
+			}
+			return static_cast<double>(m_leftOverTicks) / static_cast<double>(m_targetElapsedTicks);
+		}
+
 		// Integer format represents time using 10,000,000 ticks per second.
 		static const UINT64 TicksPerSecond = 10000000;
 
@@ -120,8 +136,16 @@ namespace DX
 
 				m_leftOverTicks += timeDelta;
 
+				UINT32 updatesThisTick = 0;
 				while (m_leftOverTicks >= m_targetElapsedTicks)
 				{
+					if (m_maxUpdatesPerTick != 0 && updatesThisTick == m_maxUpdatesPerTick)
+					{
+						m_leftOverTicks %= m_targetElapsedTicks;
+						break;
+					}
+					updatesThisTick++;
+
 					m_elapsedTicks = m_targetElapsedTicks;
 					m_totalTicks += m_targetElapsedTicks;
 					m_leftOverTicks -= m_targetElapsedTicks;
@@ -175,5 +199,6 @@ namespace DX
 		// Members for configuring fixed timestep mode.
 		bool m_isFixedTimeStep;
 		UINT64 m_targetElapsedTicks;
+		UINT32 m_maxUpdatesPerTick;
 	};
 }
@@ -71,7 +71,7 @@ void PerformanceGraph::Render()
 	Vector2ui intResolution = Tga::Engine::GetInstance()->GetRenderSize();
 	Vector2f resolution = { (float)intResolution.x, (float)intResolution.y };
 
-	float startX = 0.6f * resolution.x;
+	float startX = myPosition.x * resolution.x;
 
 	int maxVal = 0;
 	int minVal = INT_MAX;
@@ -88,7 +88,7 @@ void PerformanceGraph::Render()
 		}
 	}
 
-	Vector2f backgroundPosition = Vector2f(0.6f, 0.90f)*resolution;
+	Vector2f backgroundPosition = myPosition * resolution;
 	Vector2f backgroundSize = Vector2f(0.4f, 0.11f) * resolution;
 
 	myBackground->SetPosition(backgroundPosition);
@@ -110,13 +110,13 @@ void PerformanceGraph::Render()
 	if (myBuffer.size() > 2)
 	{
 		float lastY = (float)myBuffer[0] / (float)maxVal;
-		lastY = (9.f + lastY) * resolution.y / 10.0f;
+		lastY = (myPosition.y * 10.f + lastY) * resolution.y / 10.0f;
 
 		for (unsigned int i = 1; i < myBuffer.size(); i++)
 		{
 			float thisY = (float)myBuffer[i] / (float)maxVal;
 
-			thisY = (9.f + thisY) * resolution.y / 10.0f;
+			thisY = (myPosition.y * 10.f + thisY) * resolution.y / 10.0f;
 
 			float incrWithI = increaseX * ((float)i + 1);
 
@@ -139,7 +139,7 @@ void PerformanceGraph::Render()
 		//myDrawer->DrawLines(&theTos[0], &theFrom[0], &theColors[0], static_cast<int>(theTos.size()));
 	}
 	
-	myText->SetPosition(Vector2f(0.6f, 1.f-0.09f)* resolution);
+	myText->SetPosition(Vector2f(myPosition.x, myPosition.y + 0.01f) * resolution);
 	myText->SetScale(1.0f);
 	myText->Render();
 
@@ -16,12 +16,16 @@ namespace Tga
 		void Render();
 
 		void FeedValue(int aValue);
+
+		// Bottom left corner of the graph as a fraction of the render size, defaults to the bottom right corner
+		void SetPosition(const Vector2f& aPosition) { myPosition = aPosition; }
 	private:
 		std::unique_ptr<CustomShape2D> myBackground;
 		std::vector<int> myBuffer;
 		DebugDrawer* myDrawer;
 		Tga::Color myLineColor;
 		std::unique_ptr<Text> myText;
+		Vector2f myPosition = { 0.6f, 0.9f };
 
 	};
 }
@@ -32,44 +32,11 @@ void SpriteBatchScope::Draw(const Sprite2DInstanceData* aInstances, size_t aInst
 {
 	assert(myInstanceCount < BATCH_SIZE);
 
-	Vector2ui resolution = DX11::GetResolution();
-
 	for (int i = 0; i < aInstanceCount; i++)
 	{
-		const Sprite2DInstanceData& instance = aInstances[i];
-
-		if (instance.myIsHidden)
+		if (!SpriteDrawer::BuildInstanceData(aInstances[i], myInstanceData[myInstanceCount]))
 			continue;
 
-		SpriteShaderInstanceData& shaderInstance = myInstanceData[myInstanceCount];
-
-		Vector2f pivot = Vector2f(-instance.myPivot.x, instance.myPivot.y);
-		Matrix2x2f scalingMatrix = Matrix2x2f::CreateScaleMatrix(Vector2f((instance.mySize.x) * instance.mySizeMultiplier.x, (instance.mySize.y) * instance.mySizeMultiplier.y));
-		Matrix2x2f rotationMatrix = Matrix2x2f::CreateRotation(instance.myRotation);
-		
-		Matrix2x2f m = scalingMatrix * rotationMatrix;
-		Vector2f p = pivot * m + instance.myPosition;
-
-		shaderInstance.myTransform = Matrix4x4f
-		{
-			m(1,1),m(1,2),0,0,
-			m(2,1),m(2,2),0,0,
-			0     ,0     ,1,0,
-			p.x   ,p.y   ,0,1,
-		};
-
-		shaderInstance.myUVRect.x = instance.myTextureRect.myStartX;
-		shaderInstance.myUVRect.y = instance.myTextureRect.myEndY;
-		shaderInstance.myUVRect.z = instance.myTextureRect.myEndX;
-		shaderInstance.myUVRect.w = instance.myTextureRect.myStartY;
-
-		shaderInstance.myUV.x = instance.myUV.x;
-		shaderInstance.myUV.y = instance.myUV.y;
-		shaderInstance.myUV.z = instance.myUVScale.x;
-		shaderInstance.myUV.w = instance.myUVScale.y;
-
-		shaderInstance.myColor = instance.myColor.AsLinearVec4();
-
 		myInstanceCount++;
 		if (myInstanceCount >= BATCH_SIZE)
 		{
@@ -120,6 +87,26 @@ void SpriteBatchScope::Draw(const Sprite3DInstanceData* aInstances, size_t aInst
 	}
 }
 
+void SpriteBatchScope::Draw(const SpriteShaderInstanceData* aInstances, size_t aInstanceCount)
+{
+	assert(myInstanceCount < BATCH_SIZE);
+
+	while (aInstanceCount > 0)
+	{
+		const size_t copyCount = std::min(aInstanceCount, BATCH_SIZE - myInstanceCount);
+		memcpy(myInstanceData + myInstanceCount, aInstances, copyCount * sizeof(SpriteShaderInstanceData));
+
+		aInstances += copyCount;
+		aInstanceCount -= copyCount;
+		myInstanceCount += copyCount;
+		if (myInstanceCount >= BATCH_SIZE)
+		{
+			UnMapAndRender();
+			Map();
+		}
+	}
+}
+
 void SpriteBatchScope::UnMapAndRender()
 {
 	assert(mySpriteDrawer);
@@ -256,6 +243,41 @@ bool SpriteDrawer::CreateBuffer()
 	return true;
 }
 
+bool SpriteDrawer::BuildInstanceData(const Sprite2DInstanceData& aInstance, SpriteShaderInstanceData& aOutShaderInstance)
+{
+	if (aInstance.myIsHidden)
+		return false;
+
+	Vector2f pivot = Vector2f(-aInstance.myPivot.x, aInstance.myPivot.y);
+	Matrix2x2f scalingMatrix = Matrix2x2f::CreateScaleMatrix(Vector2f((aInstance.mySize.x) * aInstance.mySizeMultiplier.x, (aInstance.mySize.y) * aInstance.mySizeMultiplier.y));
+	Matrix2x2f rotationMatrix = Matrix2x2f::CreateRotation(aInstance.myRotation);
+
+	Matrix2x2f m = scalingMatrix * rotationMatrix;
+	Vector2f p = pivot * m + aInstance.myPosition;
+
+	aOutShaderInstance.myTransform = Matrix4x4f
+	{
+		m(1,1),m(1,2),0,0,
+		m(2,1),m(2,2),0,0,
+		0     ,0     ,1,0,
+		p.x   ,p.y   ,0,1,
+	};
+
+	aOutShaderInstance.myUVRect.x = aInstance.myTextureRect.myStartX;
+	aOutShaderInstance.myUVRect.y = aInstance.myTextureRect.myEndY;
+	aOutShaderInstance.myUVRect.z = aInstance.myTextureRect.myEndX;
+	aOutShaderInstance.myUVRect.w = aInstance.myTextureRect.myStartY;
+
+	aOutShaderInstance.myUV.x = aInstance.myUV.x;
+	aOutShaderInstance.myUV.y = aInstance.myUV.y;
+	aOutShaderInstance.myUV.z = aInstance.myUVScale.x;
+	aOutShaderInstance.myUV.w = aInstance.myUVScale.y;
+
+	aOutShaderInstance.myColor = aInstance.myColor.AsLinearVec4();
+
+	return true;
+}
+
 SpriteBatchScope SpriteDrawer::BeginBatch(const SpriteSharedData& aSharedData)
 {
 	assert(myIsLoaded);
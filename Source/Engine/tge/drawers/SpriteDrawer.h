@@ -26,6 +26,8 @@ namespace Tga
 		void Draw(const Sprite2DInstanceData* aInstances, size_t aInstanceCount);
 		void Draw(const Sprite3DInstanceData& aInstance);
 		void Draw(const Sprite3DInstanceData* aInstances, size_t aInstanceCount);
+		// Instances already converted with SpriteDrawer::BuildInstanceData
+		void Draw(const SpriteShaderInstanceData* aInstances, size_t aInstanceCount);
 	private:
 		SpriteBatchScope(SpriteDrawer& aSpriteDrawer)
 			: mySpriteDrawer(&aSpriteDrawer) {}
@@ -65,6 +67,10 @@ namespace Tga
 
 		SpriteBatchScope BeginBatch(const SpriteSharedData& aSharedData);
 
+		// Converts a sprite to the data the shader reads, returns false for hidden sprites.
+		// Does not touch the device, so it may run on any thread.
+		static bool BuildInstanceData(const Sprite2DInstanceData& aInstance, SpriteShaderInstanceData& aOutShaderInstance);
+
 	private:
 		void EndBatch();
 
@@ -0,0 +1,351 @@
+#include "stdafx.h"
+#include <tge/model/MeshBVH.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace Tga;
+
+namespace
+{
+	struct Bounds
+	{
+		Vector3f Min = Vector3f(FLT_MAX, FLT_MAX, FLT_MAX);
+		Vector3f Max = Vector3f(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+		void Grow(const Vector3f& aPoint)
+		{
+			Min = Vector3f(aPoint.x < Min.x ? aPoint.x : Min.x, aPoint.y < Min.y ? aPoint.y : Min.y, aPoint.z < Min.z ? aPoint.z : Min.z);
+			Max = Vector3f(aPoint.x > Max.x ? aPoint.x : Max.x, aPoint.y > Max.y ? aPoint.y : Max.y, aPoint.z > Max.z ? aPoint.z : Max.z);
+		}
+
+		void Grow(const Bounds& aBounds)
+		{
+			if (aBounds.Min.x <= aBounds.Max.x)
+			{
+				Grow(aBounds.Min);
+				Grow(aBounds.Max);
+			}
+		}
+
+		// Half the surface area, only ever compared against other areas
+		float GetArea() const
+		{
+			if (Min.x > Max.x)
+			{
+				return 0.0f;
+			}
+			const Vector3f size = Max - Min;
+			return size.x * size.y + size.y * size.z + size.z * size.x;
+		}
+	};
+
+	struct BuildTask
+	{
+		uint32_t First;
+		uint32_t Count;
+		int Depth;
+		// Node whose second child this task becomes, -1 for first children and the root
+		int Parent;
+	};
+
+	float GetAxis(const Vector3f& aVector, int anAxis)
+	{
+		return anAxis == 0 ? aVector.x : (anAxis == 1 ? aVector.y : aVector.z);
+	}
+}
+
+void MeshBVH::Init(const std::vector<Vector3f>& somePositions, const std::vector<uint32_t>& someIndices)
+{
+	myPositions = somePositions;
+	myIndices = someIndices;
+	myNodes.clear();
+	myTriangles.clear();
+
+	const uint32_t triangleCount = static_cast<uint32_t>(myIndices.size() / 3);
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	std::vector<Bounds> triangleBounds(triangleCount);
+	std::vector<Vector3f> centroids(triangleCount);
+	std::vector<uint32_t> order(triangleCount);
+	for (uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+	{
+		const Vector3f& v0 = myPositions[myIndices[triangle * 3]];
+		const Vector3f& v1 = myPositions[myIndices[triangle * 3 + 1]];
+		const Vector3f& v2 = myPositions[myIndices[triangle * 3 + 2]];
+		triangleBounds[triangle].Grow(v0);
+		triangleBounds[triangle].Grow(v1);
+		triangleBounds[triangle].Grow(v2);
+		centroids[triangle] = (v0 + v1 + v2) * (1.0f / 3.0f);
+		order[triangle] = triangle;
+	}
+
+	// Depth first without recursion: a node is added when its task is taken, the second child's task
+	// is pushed first so the whole first subtree is added before it
+	myNodes.reserve(triangleCount * 2);
+	std::vector<BuildTask> tasks;
+	tasks.push_back({ 0, triangleCount, 0, -1 });
+	while (!tasks.empty())
+	{
+		const BuildTask task = tasks.back();
+		tasks.pop_back();
+
+		const uint32_t nodeIndex = static_cast<uint32_t>(myNodes.size());
+		if (task.Parent >= 0)
+		{
+			myNodes[task.Parent].FirstTriangleOrChild = nodeIndex;
+		}
+
+		Bounds nodeBounds;
+		Bounds centroidBounds;
+		for (uint32_t i = task.First; i < task.First + task.Count; ++i)
+		{
+			nodeBounds.Grow(triangleBounds[order[i]]);
+			centroidBounds.Grow(centroids[order[i]]);
+		}
+
+		Node node;
+		node.BoundsMin = nodeBounds.Min;
+		node.BoundsMax = nodeBounds.Max;
+		node.FirstTriangleOrChild = task.First;
+		node.TriangleCount = task.Count;
+		myNodes.push_back(node);
+
+		if (task.Count <= 2 || task.Depth >= ourMaxDepth - 1)
+		{
+			continue;
+		}
+
+		// Bin the centroids along each axis and price every split between bins by area times triangles
+		int bestAxis = -1;
+		int bestSplit = 0;
+		float bestCost = FLT_MAX;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float axisMin = GetAxis(centroidBounds.Min, axis);
+			const float axisExtent = GetAxis(centroidBounds.Max, axis) - axisMin;
+			if (axisExtent <= 0.0f)
+			{
+				continue;
+			}
+
+			Bounds bins[ourBinCount];
+			uint32_t binCounts[ourBinCount] = {};
+			const float scale = ourBinCount / axisExtent;
+			for (uint32_t i = task.First; i < task.First + task.Count; ++i)
+			{
+				const int bin = static_cast<int>((GetAxis(centroids[order[i]], axis) - axisMin) * scale);
+				const int clampedBin = bin < ourBinCount - 1 ? bin : ourBinCount - 1;
+				bins[clampedBin].Grow(triangleBounds[order[i]]);
+				++binCounts[clampedBin];
+			}
+
+			float rightCosts[ourBinCount];
+			Bounds right;
+			uint32_t rightCount = 0;
+			for (int bin = ourBinCount - 1; bin > 0; --bin)
+			{
+				right.Grow(bins[bin]);
+				rightCount += binCounts[bin];
+				rightCosts[bin] = rightCount > 0 ? right.GetArea() * rightCount : FLT_MAX;
+			}
+
+			Bounds left;
+			uint32_t leftCount = 0;
+			for (int split = 1; split < ourBinCount; ++split)
+			{
+				left.Grow(bins[split - 1]);
+				leftCount += binCounts[split - 1];
+				if (leftCount == 0 || leftCount == task.Count)
+				{
+					continue;
+				}
+				const float cost = left.GetArea() * leftCount + rightCosts[split];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = split;
+				}
+			}
+		}
+
+		// Testing a node costs about as much as testing a triangle
+		const float leafCost = nodeBounds.GetArea() * task.Count;
+		const float splitCost = bestCost + nodeBounds.GetArea();
+		if (task.Count <= ourMaxLeafSize && (bestAxis < 0 || splitCost >= leafCost))
+		{
+			continue;
+		}
+
+		uint32_t leftCount = task.Count / 2;
+		if (bestAxis >= 0)
+		{
+			const float axisMin = GetAxis(centroidBounds.Min, bestAxis);
+			const float scale = ourBinCount / (GetAxis(centroidBounds.Max, bestAxis) - axisMin);
+			auto middle = std::partition(order.begin() + task.First, order.begin() + task.First + task.Count, [&](uint32_t aTriangle)
+			{
+				const int bin = static_cast<int>((GetAxis(centroids[aTriangle], bestAxis) - axisMin) * scale);
+				return (bin < ourBinCount - 1 ? bin : ourBinCount - 1) < bestSplit;
+			});
+			leftCount = static_cast<uint32_t>(middle - (order.begin() + task.First));
+		}
+		// Otherwise every centroid is in the same place and any split is as good as another
+
+		myNodes[nodeIndex].TriangleCount = 0;
+		tasks.push_back({ task.First + leftCount, task.Count - leftCount, task.Depth + 1, static_cast<int>(nodeIndex) });
+		tasks.push_back({ task.First, leftCount, task.Depth + 1, -1 });
+	}
+
+	myTriangles.resize(triangleCount);
+	for (uint32_t i = 0; i < triangleCount; ++i)
+	{
+		const uint32_t triangle = order[i];
+		const Vector3f& v0 = myPositions[myIndices[triangle * 3]];
+		myTriangles[i].V0 = v0;
+		myTriangles[i].Edge1 = myPositions[myIndices[triangle * 3 + 1]] - v0;
+		myTriangles[i].Edge2 = myPositions[myIndices[triangle * 3 + 2]] - v0;
+		myTriangles[i].Index = triangle;
+	}
+}
+
+bool MeshBVH::Raycast(const Vector3f& anOrigin, const Vector3f& aDirection, float aMaxDistance, MeshRayHit& outHit) const
+{
+	if (myNodes.empty())
+	{
+		return false;
+	}
+
+	// Zero components get the largest float instead of infinity so the slab test never hits 0 * inf
+	const Vector3f inverseDirection(
+		aDirection.x != 0.0f ? 1.0f / aDirection.x : FLT_MAX,
+		aDirection.y != 0.0f ? 1.0f / aDirection.y : FLT_MAX,
+		aDirection.z != 0.0f ? 1.0f / aDirection.z : FLT_MAX);
+
+	float closest = aMaxDistance;
+	bool isHit = false;
+
+	uint32_t stack[ourMaxDepth];
+	int stackSize = 0;
+	uint32_t nodeIndex = 0;
+	if (IntersectBounds(myNodes[0], anOrigin, inverseDirection, closest) == FLT_MAX)
+	{
+		return false;
+	}
+
+	while (true)
+	{
+		const Node& node = myNodes[nodeIndex];
+		if (node.TriangleCount > 0)
+		{
+			// Moller-Trumbore
+			for (uint32_t i = node.FirstTriangleOrChild; i < node.FirstTriangleOrChild + node.TriangleCount; ++i)
+			{
+				const Triangle& triangle = myTriangles[i];
+				const Vector3f p = aDirection.Cross(triangle.Edge2);
+				const float determinant = triangle.Edge1.Dot(p);
+				if (determinant > -1e-12f && determinant < 1e-12f)
+				{
+					continue;
+				}
+
+				const float inverseDeterminant = 1.0f / determinant;
+				const Vector3f s = anOrigin - triangle.V0;
+				const float u = s.Dot(p) * inverseDeterminant;
+				if (u < 0.0f || u > 1.0f)
+				{
+					continue;
+				}
+
+				const Vector3f q = s.Cross(triangle.Edge1);
+				const float v = aDirection.Dot(q) * inverseDeterminant;
+				if (v < 0.0f || u + v > 1.0f)
+				{
+					continue;
+				}
+
+				const float distance = triangle.Edge2.Dot(q) * inverseDeterminant;
+				if (distance < 0.0f || distance >= closest)
+				{
+					continue;
+				}
+
+				closest = distance;
+				isHit = true;
+				outHit.Distance = distance;
+				outHit.Triangle = triangle.Index;
+				outHit.U = u;
+				outHit.V = v;
+			}
+		}
+		else
+		{
+			// Visit the nearer child first, the other one may be skipped once something closer is hit
+			uint32_t nearChild = nodeIndex + 1;
+			uint32_t farChild = node.FirstTriangleOrChild;
+			float nearDistance = IntersectBounds(myNodes[nearChild], anOrigin, inverseDirection, closest);
+			float farDistance = IntersectBounds(myNodes[farChild], anOrigin, inverseDirection, closest);
+			if (farDistance < nearDistance)
+			{
+				const uint32_t child = nearChild;
+				nearChild = farChild;
+				farChild = child;
+				const float distance = nearDistance;
+				nearDistance = farDistance;
+				farDistance = distance;
+			}
+
+			if (nearDistance != FLT_MAX)
+			{
+				if (farDistance != FLT_MAX)
+				{
+					stack[stackSize++] = farChild;
+				}
+				nodeIndex = nearChild;
+				continue;
+			}
+		}
+
+		if (stackSize == 0)
+		{
+			break;
+		}
+		nodeIndex = stack[--stackSize];
+	}
+
+	return isHit;
+}
+
+bool MeshBVH::Raycast(const Matrix4x4f& aLocalToWorld, const Vector3f& anOrigin, const Vector3f& aDirection, float aMaxDistance, MeshRayHit& outHit) const
+{
+	// Affine transforms keep the ray parameter, so hits along the unnormalized local direction are at
+	// the same distance as along the world direction
+	const Matrix4x4f worldToLocal = aLocalToWorld.GetInverse();
+	const Vector3f localOrigin = (Vector4f(anOrigin, 1.0f) * worldToLocal).ToVector3();
+	const Vector3f localDirection = (Vector4f(aDirection, 0.0f) * worldToLocal).ToVector3();
+	return Raycast(localOrigin, localDirection, aMaxDistance, outHit);
+}
+
+float MeshBVH::IntersectBounds(const Node& aNode, const Vector3f& anOrigin, const Vector3f& anInverseDirection, float aMaxDistance)
+{
+	const float x1 = (aNode.BoundsMin.x - anOrigin.x) * anInverseDirection.x;
+	const float x2 = (aNode.BoundsMax.x - anOrigin.x) * anInverseDirection.x;
+	const float y1 = (aNode.BoundsMin.y - anOrigin.y) * anInverseDirection.y;
+	const float y2 = (aNode.BoundsMax.y - anOrigin.y) * anInverseDirection.y;
+	const float z1 = (aNode.BoundsMin.z - anOrigin.z) * anInverseDirection.z;
+	const float z2 = (aNode.BoundsMax.z - anOrigin.z) * anInverseDirection.z;
+
+	float entry = x1 < x2 ? x1 : x2;
+	float exit = x1 < x2 ? x2 : x1;
+	entry = (y1 < y2 ? y1 : y2) > entry ? (y1 < y2 ? y1 : y2) : entry;
+	exit = (y1 < y2 ? y2 : y1) < exit ? (y1 < y2 ? y2 : y1) : exit;
+	entry = (z1 < z2 ? z1 : z2) > entry ? (z1 < z2 ? z1 : z2) : entry;
+	exit = (z1 < z2 ? z2 : z1) < exit ? (z1 < z2 ? z2 : z1) : exit;
+	entry = entry > 0.0f ? entry : 0.0f;
+
+	return entry <= exit && entry <= aMaxDistance ? entry : FLT_MAX;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include <tge/Math/Vector.h>
+#include <tge/Math/Matrix4x4.h>
+
+namespace Tga
+{
+
+struct MeshRayHit
+{
+	// Distance along the ray in units of the ray direction's length
+	float Distance;
+	// Index of the triangle in the mesh's index list, its indices start at Triangle * 3
+	uint32_t Triangle;
+	// Weights of the triangle's second and third vertex, the first one gets 1 - U - V
+	float U;
+	float V;
+};
+
+// A CPU copy of a mesh's positions and indices with a bounding volume hierarchy over its triangles,
+// for ray casts against the real geometry. Built once with a binned surface area heuristic, the nodes
+// are stored depth first in one array so a node's first child always follows it.
+// Queries only read the hierarchy and can run from several threads at once.
+class MeshBVH
+{
+public:
+	void Init(const std::vector<Vector3f>& somePositions, const std::vector<uint32_t>& someIndices);
+
+	// Closest hit closer than aMaxDistance, triangles are hit from both sides.
+	// The direction does not have to be normalized, distances are measured in its length.
+	bool Raycast(const Vector3f& anOrigin, const Vector3f& aDirection, float aMaxDistance, MeshRayHit& outHit) const;
+
+	// Same with the ray in world space and the mesh placed by aLocalToWorld, for example a
+	// ModelInstance's transform. The distance stays in world units of aDirection's length.
+	bool Raycast(const Matrix4x4f& aLocalToWorld, const Vector3f& anOrigin, const Vector3f& aDirection, float aMaxDistance, MeshRayHit& outHit) const;
+
+	const std::vector<Vector3f>& GetPositions() const { return myPositions; }
+	const std::vector<uint32_t>& GetIndices() const { return myIndices; }
+	size_t GetTriangleCount() const { return myTriangles.size(); }
+	size_t GetNodeCount() const { return myNodes.size(); }
+
+private:
+	struct Node
+	{
+		Vector3f BoundsMin;
+		// Leaves: first triangle in myTriangles. Inner nodes: index of the second child.
+		uint32_t FirstTriangleOrChild;
+		Vector3f BoundsMax;
+		// 0 for inner nodes
+		uint32_t TriangleCount;
+	};
+
+	// Stored in hierarchy order with the edges the intersection test needs
+	struct Triangle
+	{
+		Vector3f V0;
+		Vector3f Edge1;
+		Vector3f Edge2;
+		uint32_t Index;
+	};
+
+	static constexpr int ourMaxDepth = 64;
+	static constexpr int ourBinCount = 16;
+	static constexpr uint32_t ourMaxLeafSize = 8;
+
+	// Entry distance, FLT_MAX when the ray misses the node or enters it after aMaxDistance
+	static float IntersectBounds(const Node& aNode, const Vector3f& anOrigin, const Vector3f& anInverseDirection, float aMaxDistance);
+
+	std::vector<Vector3f> myPositions;
+	std::vector<uint32_t> myIndices;
+	std::vector<Node> myNodes;
+	std::vector<Triangle> myTriangles;
+};
+
+} // namespace Tga
@@ -1,4 +1,5 @@
 #pragma once
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -13,6 +14,7 @@ namespace Tga
 {
 
 class TextureResource;
+class MeshBVH;
 
 struct BoxSphereBounds
 {
@@ -41,6 +43,9 @@ public:
 		ID3D11Buffer* VertexBuffer;
 		ID3D11Buffer* IndexBuffer;
 		BoxSphereBounds Bounds;
+		// Positions, indices and a triangle BVH kept on the CPU for ray casts, only there when the
+		// ModelFactory was asked to retain CPU meshes before loading the model
+		std::shared_ptr<const MeshBVH> CpuMesh;
 	};
 		
 	void Init(MeshData& aMeshData, const std::wstring& aPath);
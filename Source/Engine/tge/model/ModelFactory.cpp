@@ -6,6 +6,7 @@
 #include <tge/animation/animationPlayer.h>
 #include <tge/graphics/DX11.h>
 #include <tge/util/StringCast.h>
+#include <tge/model/MeshBVH.h>
 #include <tge/model/Model.h>
 #include <tge/model/ModelInstance.h>
 #include <tge/graphics/Vertex.h>
@@ -373,6 +374,8 @@ bool ModelFactory::InitUnitCube()
     meshData.VertexBuffer = vertexBuffer;
     meshData.IndexBuffer = indexBuffer;
     meshData.Bounds = CalculateBoxSphereBounds(mdlVertices);
+    // Primitives are tiny, they always keep their CPU mesh
+    meshData.CpuMesh = CreateCpuMesh(mdlVertices, mdlIndices);
     model->Init(meshData, L"Cube");
     myLoadedModels.insert(std::pair<std::wstring, std::shared_ptr<Model>>(L"Cube", model));
 
@@ -469,6 +472,8 @@ bool ModelFactory::InitUnitPlane()
     meshData.VertexBuffer = vertexBuffer;
     meshData.IndexBuffer = indexBuffer;
     meshData.Bounds = CalculateBoxSphereBounds(mdlVertices);
+    // Primitives are tiny, they always keep their CPU mesh
+    meshData.CpuMesh = CreateCpuMesh(mdlVertices, mdlIndices);
     model->Init(meshData, L"Plane");
     myLoadedModels.insert(std::pair<std::wstring, std::shared_ptr<Model>>(L"Plane", model));
 	
@@ -793,6 +798,10 @@ std::shared_ptr<Model> ModelFactory::LoadModel(const std::wstring& someFilePath)
                 meshData.MaterialName = "";
             }
             meshData.Bounds = CalculateBoxSphereBounds(mdlVertices);
+            if (myRetainCpuMeshes)
+            {
+                meshData.CpuMesh = CreateCpuMesh(mdlVertices, mdlIndices);
+            }
         }
 
         std::shared_ptr<Model> model = std::make_shared<Model>();
@@ -884,6 +893,19 @@ std::shared_ptr<Animation> ModelFactory::GetAnimation(const std::wstring& someFi
 }
 #pragma optimize("", on)
 
+std::shared_ptr<const MeshBVH> Tga::ModelFactory::CreateCpuMesh(const std::vector<Tga::Vertex>& someVertices, const std::vector<unsigned int>& someIndices)
+{
+    std::vector<Vector3f> positions(someVertices.size());
+    for (size_t v = 0; v < someVertices.size(); v++)
+    {
+        positions[v] = Vector3f(someVertices[v].Position.x, someVertices[v].Position.y, someVertices[v].Position.z);
+    }
+
+    std::shared_ptr<MeshBVH> mesh = std::make_shared<MeshBVH>();
+    mesh->Init(positions, someIndices);
+    return mesh;
+}
+
 AnimationPlayer ModelFactory::GetAnimationPlayer(const std::wstring& someFilePath, const std::shared_ptr<Model>& aModel)
 {
     AnimationPlayer instance;
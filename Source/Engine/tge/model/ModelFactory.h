@@ -19,6 +19,7 @@ class AnimatedModel;
 
 class ModelInstance;
 class Model;
+class MeshBVH;
 
 class ModelFactory
 {
@@ -45,10 +46,16 @@ public:
 	ModelInstance GetUnitCube();
 	ModelInstance GetUnitPlane();
 	bool ModelHasMesh(const std::wstring& someFilePath);
+
+	// Keep positions, indices and a triangle BVH on the CPU for every mesh loaded from now on, see
+	// Model::MeshData::CpuMesh. Models that were already loaded are not changed.
+	void SetRetainCpuMeshes(bool aRetainCpuMeshes) { myRetainCpuMeshes = aRetainCpuMeshes; }
+	bool GetRetainCpuMeshes() const { return myRetainCpuMeshes; }
 protected:
 	
 	std::shared_ptr<Model> LoadModel(const std::wstring& someFilePath);
 	Tga::BoxSphereBounds CalculateBoxSphereBounds(std::vector<Tga::Vertex> somePositions);
+	static std::shared_ptr<const MeshBVH> CreateCpuMesh(const std::vector<Tga::Vertex>& someVertices, const std::vector<unsigned int>& someIndices);
 private:	
 	struct AnimationIdentifer
 	{
@@ -70,6 +77,8 @@ private:
 	std::unordered_map<std::wstring, std::shared_ptr<Model>> myLoadedModels;	
 	std::unordered_map<AnimationIdentifer, std::shared_ptr<Animation>, AnimationIdentiferHash> myLoadedAnimations;
 
+	bool myRetainCpuMeshes = false;
+
 	static ModelFactory* myInstance;
 };
 
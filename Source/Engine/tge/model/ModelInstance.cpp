@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include <tge/model/ModelInstance.h>
 #include <tge/model/Model.h>
+#include <tge/model/MeshBVH.h>
 #include <tge/shaders/ModelShader.h>
 
 using namespace Tga;
@@ -47,3 +48,30 @@ void ModelInstance::Render(const ModelShader& shader) const
 	}
 }
 
+
+bool ModelInstance::Raycast(const Vector3f& anOrigin, const Vector3f& aDirection, float aMaxDistance, MeshRayHit& outHit, unsigned int& outMeshIndex) const
+{
+	if (!myModel)
+	{
+		return false;
+	}
+
+	// Move the ray into model space once for all meshes, see MeshBVH::Raycast
+	const Matrix4x4f worldToLocal = myTransform.GetMatrix().GetInverse();
+	const Vector3f localOrigin = (Vector4f(anOrigin, 1.0f) * worldToLocal).ToVector3();
+	const Vector3f localDirection = (Vector4f(aDirection, 0.0f) * worldToLocal).ToVector3();
+
+	const std::vector<Model::MeshData>& meshData = myModel->GetMeshDataList();
+	float closest = aMaxDistance;
+	bool isHit = false;
+	for (unsigned int j = 0; j < meshData.size(); j++)
+	{
+		if (meshData[j].CpuMesh && meshData[j].CpuMesh->Raycast(localOrigin, localDirection, closest, outHit))
+		{
+			closest = outHit.Distance;
+			outMeshIndex = j;
+			isHit = true;
+		}
+	}
+	return isHit;
+}
@@ -9,6 +9,7 @@ namespace Tga
 
 class Model;
 class ModelShader;
+struct MeshRayHit;
 class ModelInstance : public RenderObjectSharedData
 {
 public:
@@ -27,6 +28,10 @@ public:
 	const TextureResource* const* GetTextures(size_t meshIndex) const { return myTextures[meshIndex]; }
 	bool IsValid() { return myModel ? true : false; }
 	void Render(const ModelShader& shader) const;
+
+	// Closest hit on the meshes that have a CPU mesh, the ray is in world space and the distance in
+	// units of aDirection's length. outMeshIndex is the index of the hit mesh in the model.
+	bool Raycast(const Vector3f& anOrigin, const Vector3f& aDirection, float aMaxDistance, MeshRayHit& outHit, unsigned int& outMeshIndex) const;
 private:
 
 	std::shared_ptr<Model> myModel{};
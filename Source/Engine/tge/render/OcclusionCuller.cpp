@@ -0,0 +1,108 @@
+#include "stdafx.h"
+#include <tge/render/OcclusionCuller.h>
+#include <tge/graphics/Camera.h>
+#include <tge/model/MeshBVH.h>
+#include <tge/model/Model.h>
+#include <tge/model/ModelInstance.h>
+
+using namespace Tga;
+
+namespace
+{
+	// Both store the rows one after another and multiply row vectors
+	CU::Matrix4x4f ToCU(const Matrix4x4f& aMatrix)
+	{
+		CU::Matrix4x4f matrix;
+		for (int row = 1; row <= 4; row++)
+		{
+			for (int column = 1; column <= 4; column++)
+			{
+				matrix(row, column) = aMatrix(row, column);
+			}
+		}
+		return matrix;
+	}
+
+	CU::Vector3f ToCU(const Vector3f& aVector)
+	{
+		return CU::Vector3f(aVector.x, aVector.y, aVector.z);
+	}
+}
+
+OcclusionCuller::OcclusionCuller(CU::ThreadPool* aThreadPool)
+	: myCuller(aThreadPool)
+{
+}
+
+void OcclusionCuller::Init(unsigned int aWidth, unsigned int aHeight)
+{
+	myCuller.Init(aWidth, aHeight);
+}
+
+void OcclusionCuller::BeginFrame(const Matrix4x4f& aViewProjection)
+{
+	myCuller.BeginFrame(ToCU(aViewProjection));
+}
+
+void OcclusionCuller::BeginFrame(const Camera& aCamera)
+{
+	BeginFrame(Matrix4x4f::GetFastInverse(aCamera.GetTransform().GetMatrix()) * aCamera.GetProjection());
+}
+
+void OcclusionCuller::AddOccluder(const Matrix4x4f& aLocalToWorld, const std::vector<Vector3f>& somePositions, const std::vector<uint32_t>& someIndices)
+{
+	static_assert(sizeof(Vector3f) == sizeof(float) * 3, "Positions are passed on as packed x, y, z triples");
+	myCuller.AddOccluder(ToCU(aLocalToWorld), somePositions.empty() ? nullptr : &somePositions[0].x, somePositions.size(), someIndices.data(), someIndices.size());
+}
+
+void OcclusionCuller::AddOccluder(const ModelInstance& anInstance)
+{
+	const Model* model = anInstance.GetModel();
+	if (!model)
+	{
+		return;
+	}
+
+	const Matrix4x4f localToWorld = anInstance.GetTransform().GetMatrix();
+	for (const Model::MeshData& meshData : model->GetMeshDataList())
+	{
+		if (meshData.CpuMesh)
+		{
+			AddOccluder(localToWorld, meshData.CpuMesh->GetPositions(), meshData.CpuMesh->GetIndices());
+		}
+	}
+}
+
+void OcclusionCuller::EndFrame()
+{
+	myCuller.EndFrame();
+}
+
+bool OcclusionCuller::IsVisible(const Matrix4x4f& aLocalToWorld, const BoxSphereBounds& someBounds) const
+{
+	return myCuller.IsVisible(ToCU(aLocalToWorld), ToCU(someBounds.Center), ToCU(someBounds.BoxExtents));
+}
+
+bool OcclusionCuller::IsVisible(const ModelInstance& anInstance) const
+{
+	const Model* model = anInstance.GetModel();
+	if (!model)
+	{
+		return false;
+	}
+
+	const CU::Matrix4x4f localToWorld = ToCU(anInstance.GetTransform().GetMatrix());
+	for (const Model::MeshData& meshData : model->GetMeshDataList())
+	{
+		if (myCuller.IsVisible(localToWorld, ToCU(meshData.Bounds.Center), ToCU(meshData.Bounds.BoxExtents)))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void OcclusionCuller::CullInstances(const std::vector<const ModelInstance*>& someInstances, std::vector<uint32_t>& outVisible)
+{
+	myCuller.Cull(someInstances.size(), [this, &someInstances](size_t anIndex) { return IsVisible(*someInstances[anIndex]); }, outVisible);
+}
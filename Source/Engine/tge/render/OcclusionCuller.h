@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include <tge/Math/Vector.h>
+#include <tge/Math/Matrix4x4.h>
+
+#include <CommonUtilities/Collision/OcclusionCuller.h>
+
+namespace CU
+{
+	class ThreadPool;
+}
+
+namespace Tga
+{
+
+class Camera;
+class ModelInstance;
+struct BoxSphereBounds;
+
+// Engine side of CU::OcclusionCuller, which does the rasterizing and testing without any engine types.
+// Takes cameras, model instances and the engine's math types and passes them on.
+// Depth is clip space z / w as the camera's projection writes it, smaller is closer.
+class OcclusionCuller
+{
+public:
+	static constexpr unsigned int ourTileSize = CU::OcclusionCuller::ourTileSize;
+
+	// Without a thread pool all tiles and tests run on the calling thread. Starts at the default size.
+	explicit OcclusionCuller(CU::ThreadPool* aThreadPool = nullptr);
+	OcclusionCuller(const OcclusionCuller& anOcclusionCuller) = delete;
+	OcclusionCuller& operator=(const OcclusionCuller& anOcclusionCuller) = delete;
+	~OcclusionCuller() = default;
+
+	// The size is rounded up to whole tiles, keep it well below the screen's, 256 x 128 is plenty
+	void Init(unsigned int aWidth = 256, unsigned int aHeight = 128);
+
+	// Starts a frame seen through aViewProjection, the view matrix times the projection
+	void BeginFrame(const Matrix4x4f& aViewProjection);
+	void BeginFrame(const Camera& aCamera);
+
+	// Occluders are triangle lists placed by aLocalToWorld, they are drawn from both sides.
+	// Triangles crossing the near plane are clipped, so walls the camera stands next to still occlude.
+	void AddOccluder(const Matrix4x4f& aLocalToWorld, const std::vector<Vector3f>& somePositions, const std::vector<uint32_t>& someIndices);
+	// Uses the meshes' CPU meshes, so the model must be loaded while the ModelFactory retains them
+	void AddOccluder(const ModelInstance& anInstance);
+
+	// Rasterizes this frame's occluders and builds the depth pyramid, call before testing
+	void EndFrame();
+
+	// False when the box of someBounds placed by aLocalToWorld is hidden behind the occluders or off
+	// screen. Boxes reaching in front of the near plane are always visible. Safe from several threads.
+	bool IsVisible(const Matrix4x4f& aLocalToWorld, const BoxSphereBounds& someBounds) const;
+	// Visible when any of the model's meshes is
+	bool IsVisible(const ModelInstance& anInstance) const;
+
+	// Indices of the visible instances, in order. Replaces the content of outVisible.
+	// The instances are tested in chunks on the thread pool.
+	void CullInstances(const std::vector<const ModelInstance*>& someInstances, std::vector<uint32_t>& outVisible);
+
+	unsigned int GetWidth() const { return myCuller.GetWidth(); }
+	unsigned int GetHeight() const { return myCuller.GetHeight(); }
+	// Nearest occluder depth per pixel, rows top to bottom, FLT_MAX where nothing was drawn
+	const std::vector<float>& GetDepthBuffer() const { return myCuller.GetDepthBuffer(); }
+	size_t GetOccluderTriangleCount() const { return myCuller.GetOccluderTriangleCount(); }
+
+private:
+	CU::OcclusionCuller myCuller;
+};
+
+} // namespace Tga
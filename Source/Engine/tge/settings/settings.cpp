@@ -104,6 +104,13 @@ std::wstring Tga::Settings::GameSettingsW(const std::wstring& aKey) {
 	std::string s = game_settings[Tga::FromWstring(aKey)];
 	return Tga::ToWstring(s);
 }
+double Tga::Settings::GameSettingsNumber(const std::string& aKey, double aDefault) {
+	auto it = game_settings.find(aKey);
+	if (it == game_settings.end() || !it->is_number()) {
+		return aDefault;
+	}
+	return it->get<double>();
+}
 
 void Tga::LoadSettings(const std::string& aProjectName) {
 	using namespace Settings;
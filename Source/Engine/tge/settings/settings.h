@@ -29,5 +29,7 @@ namespace Tga {
 		extern std::string GameSettings(const std::string& aKey);
 		extern std::wstring GameSettingsW(const std::string& aKey);
 		extern std::wstring GameSettingsW(const std::wstring& aKey);
+		// aDefault when the key is missing or not a number
+		extern double GameSettingsNumber(const std::string& aKey, double aDefault);
 	}
 }
\ No newline at end of file
@@ -80,6 +80,26 @@ bool IsTarga(std::wstring aPath)
 }
 
 Texture* TextureManager::GetTexture(const wchar_t* aTexturePath, bool aForceSRGB, bool aForceReload)
+{
+	Texture* texture = LoadTexture(aTexturePath, aForceSRGB, aForceReload);
+	if (texture)
+	{
+		texture->myIsKeptLoaded = true;
+	}
+	return texture;
+}
+
+Texture* TextureManager::AcquireTexture(const wchar_t* aTexturePath, bool aForceSRGB)
+{
+	Texture* texture = LoadTexture(aTexturePath, aForceSRGB, false);
+	if (texture)
+	{
+		++texture->myUseCount;
+	}
+	return texture;
+}
+
+Texture* TextureManager::LoadTexture(const wchar_t* aTexturePath, bool aForceSRGB, bool aForceReload)
 {
 	if (!aTexturePath)
 	{
@@ -95,7 +115,7 @@ Texture* TextureManager::GetTexture(const wchar_t* aTexturePath, bool aForceSRGB
 	{
 		loadedTexture = it->get();
 	}
-	if (!aForceReload && loadedTexture)
+	if (!aForceReload && loadedTexture && !loadedTexture->myIsReleased)
 	{
 		Texture* texture = it->get();
 		return texture;
@@ -204,6 +224,7 @@ Texture* TextureManager::GetTexture(const wchar_t* aTexturePath, bool aForceSRGB
 		newTexture->myID = hashedID;
 		SetDebugObjectName(newTexture->GetShaderResourceView(), asset_path);
 		newTexture->myIsFailedTexture = true;
+		newTexture->myIsReleased = false;
 
 		Vector2f texSize = GetTextureSize(resource.Get());
 		newTexture->mySize = Vector2f(0.3f, 0.3f);
@@ -226,6 +247,7 @@ Texture* TextureManager::GetTexture(const wchar_t* aTexturePath, bool aForceSRGB
 		newTexture->myPath = asset_path;
 		newTexture->myID = hashedID;
 		newTexture->SetShaderResourceView(resource.Get());
+		newTexture->myIsReleased = false;
 		SetDebugObjectName(newTexture->GetShaderResourceView(), asset_path);
 
 		Vector2f texSize = GetTextureSize(resource.Get());
@@ -245,6 +267,16 @@ Texture* TextureManager::GetTexture(const wchar_t* aTexturePath, bool aForceSRGB
 }
 
 Texture* TextureManager::TryGetTexture(const wchar_t* aTexturePath, bool aForceSRGB)
+{
+	Texture* texture = TryLoadTexture(aTexturePath, aForceSRGB);
+	if (texture)
+	{
+		texture->myIsKeptLoaded = true;
+	}
+	return texture;
+}
+
+Texture* TextureManager::TryLoadTexture(const wchar_t* aTexturePath, bool aForceSRGB)
 {
 	if (!aTexturePath)
 	{
@@ -260,7 +292,7 @@ Texture* TextureManager::TryGetTexture(const wchar_t* aTexturePath, bool aForceS
 	{
 		loadedTexture = it->get();
 	}
-	if (loadedTexture)
+	if (loadedTexture && !loadedTexture->myIsReleased)
 	{
 		Texture* texture = it->get();
 		return texture;
@@ -358,6 +390,7 @@ Texture* TextureManager::TryGetTexture(const wchar_t* aTexturePath, bool aForceS
 		newTexture->myPath = aTexturePath;
 		newTexture->myID = hashedID;
 		newTexture->SetShaderResourceView(resource.Get());
+		newTexture->myIsReleased = false;
 		SetDebugObjectName(newTexture->GetShaderResourceView(), aTexturePath);
 
 		Vector2f texSize = GetTextureSize(resource.Get());
@@ -376,6 +409,70 @@ Texture* TextureManager::TryGetTexture(const wchar_t* aTexturePath, bool aForceS
 	return nullptr;
 }
 
+Texture* TextureManager::GetTextureFromMemory(const wchar_t* aTexturePath, const uint8_t* aData, size_t aDataSize, bool aForceSRGB)
+{
+	if (!aTexturePath)
+	{
+		aTexturePath = L"";
+	}
+
+	std::wstring toString = aTexturePath;
+	const uint64_t hashedID = xxh64::hash((char*)toString.c_str(), sizeof(wchar_t) * toString.length(), 0);
+	auto it = std::find_if(myResourceViews.begin(), myResourceViews.end(), [hashedID](const std::unique_ptr<Texture>& s) { return s->myID == hashedID; });
+	Texture* loadedTexture = it != myResourceViews.end() ? it->get() : nullptr;
+	if (loadedTexture && !loadedTexture->myIsReleased)
+	{
+		return loadedTexture;
+	}
+
+	if (!aData || aDataSize == 0)
+	{
+		return LoadTexture(aTexturePath, aForceSRGB, false);
+	}
+
+	ComPtr<ID3D11ShaderResourceView> resource;
+	HRESULT hr = DirectX::CreateDDSTextureFromMemoryEx(DX11::Device, nullptr,
+		aData, aDataSize, 0,
+		D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0,
+		aForceSRGB,
+		nullptr, resource.ReleaseAndGetAddressOf(), nullptr);
+
+	if (FAILED(hr) && CAN_USE_OTHER_FORMATS_THAN_DDS && DX11::IsOnSameThreadAsEngine())
+	{
+		hr = DirectX::CreateWICTextureFromMemory(DX11::Device, DX11::Context, aData, aDataSize, nullptr,
+			resource.ReleaseAndGetAddressOf());
+	}
+
+	if (FAILED(hr))
+	{
+		// Targa, forbidden formats and error textures are all handled by the file path
+		return LoadTexture(aTexturePath, aForceSRGB, false);
+	}
+
+	const std::wstring asset_path = Settings::GetAssetW(aTexturePath);
+
+	Texture* newTexture = loadedTexture;
+	if (!loadedTexture)
+	{
+		Engine::GetInstance()->GetFileWatcher()->WatchFileChange(asset_path, std::bind(&Tga::TextureManager::OnTextureChanged, this, std::placeholders::_1));
+		newTexture = new Texture();
+	}
+	newTexture->myPath = asset_path;
+	newTexture->myID = hashedID;
+	newTexture->SetShaderResourceView(resource.Get());
+	newTexture->myIsReleased = false;
+	SetDebugObjectName(newTexture->GetShaderResourceView(), asset_path);
+
+	newTexture->mySize = GetTextureSize(resource.Get());
+	newTexture->myImageSize = GetTextureSize(resource.Get(), false);
+
+	if (!loadedTexture)
+	{
+		myResourceViews.push_back(std::unique_ptr<Texture>(newTexture));
+	}
+	return newTexture;
+}
+
 void TextureManager::OnTextureChanged(std::wstring aFile)
 {
 	std::wstring notWide = aFile;
@@ -385,7 +482,7 @@ void TextureManager::OnTextureChanged(std::wstring aFile)
 		if (myResourceViews[i]->myPath.compare(notWide) != std::wstring::npos)
 		{
 			INFO_PRINT("%s%s", "Texture changed: ", notWide.c_str());
-			GetTexture(notWide.c_str(), true);
+			LoadTexture(notWide.c_str(), true, false);
 			break;
 		}
 	}
@@ -677,9 +774,52 @@ void Tga::TextureManager::Init()
 
 void Tga::TextureManager::ReleaseTexture(Texture* aTexture)
 {
-	aTexture->SetShaderResourceView(myFailedResource.Get());
+	if (!aTexture || aTexture->myUseCount == 0)
+	{
+		return;
+	}
+
+	--aTexture->myUseCount;
+	if (aTexture->myUseCount > 0 || aTexture->myIsKeptLoaded)
+	{
+		return;
+	}
+
+	// Frames recorded before this one may still draw the texture
+	auto pending = std::find_if(myPendingReleases.begin(), myPendingReleases.end(), [aTexture](const PendingRelease& aRelease) { return aRelease.myTexture == aTexture; });
+	if (pending != myPendingReleases.end())
+	{
+		pending->myFramesLeft = myReleaseDelay;
+		return;
+	}
+	myPendingReleases.push_back({ aTexture, myReleaseDelay });
+}
+
+void Tga::TextureManager::SetReleaseDelay(unsigned int aFrameCount)
+{
+	myReleaseDelay = aFrameCount;
 }
 
 void Tga::TextureManager::Update()
 {
+	for (size_t index = 0; index < myPendingReleases.size();)
+	{
+		PendingRelease& release = myPendingReleases[index];
+		if (release.myFramesLeft > 0)
+		{
+			--release.myFramesLeft;
+			++index;
+			continue;
+		}
+
+		// Skipped when the texture was acquired again while waiting
+		Texture* texture = release.myTexture;
+		if (texture->myUseCount == 0 && !texture->myIsKeptLoaded)
+		{
+			texture->SetShaderResourceView(myFailedResource.Get());
+			texture->myIsReleased = true;
+		}
+		release = myPendingReleases.back();
+		myPendingReleases.pop_back();
+	}
 }
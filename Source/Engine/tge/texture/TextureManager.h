@@ -19,21 +19,45 @@ namespace Tga
 		TextureManager(void);
 		~TextureManager(void);
 		void Init();
+		// Textures fetched here stay loaded, ReleaseTexture never frees them
 		Texture* GetTexture(const wchar_t* aTexturePath, bool aForceSRGB = true, bool aForceReload = false);
 		Texture* TryGetTexture(const wchar_t* aTexturePath, bool aForceSRGB = true);
 
+		// Like GetTexture, but counts a use that ReleaseTexture gives back. Call once per ReleaseTexture.
+		Texture* AcquireTexture(const wchar_t* aTexturePath, bool aForceSRGB = true);
+
+		// Creates the texture from file contents that were already read into memory, for example on a loader thread.
+		// aTexturePath is used as the cache key, so a later GetTexture with the same path returns this texture.
+		Texture* GetTextureFromMemory(const wchar_t* aTexturePath, const uint8_t* aData, size_t aDataSize, bool aForceSRGB = true);
+
 		Texture* GetWhiteSquareTexture() { return myWhiteSquareTexture.get(); }
 		static Vector2f GetTextureSize(struct ID3D11ShaderResourceView* aResourceView, bool aNormalize = true);
 
 		Texture * CreateTextureFromTarga(Tga32::Image * aImage);
 
+		// Gives back a use from AcquireTexture. Once no use is left, and nobody fetched the path with GetTexture,
+		// the GPU memory is freed after the release delay and the texture shows the error texture until the
+		// next GetTexture or AcquireTexture of its path reloads it
 		void ReleaseTexture(Texture* aTexture);
 
+		// Frames a released texture is kept for, set it to the renderer's frame latency so frames recorded
+		// before the release still draw it
+		void SetReleaseDelay(unsigned int aFrameCount);
+
 		void Update();
 
 		/* Requires DX11 includes */
 		ID3D11ShaderResourceView* GetDefaultNormalMapResource() const { return myDefaultNormalMapResource.Get(); }
 	private:
+		struct PendingRelease
+		{
+			Texture* myTexture;
+			unsigned int myFramesLeft;
+		};
+
+		Texture* LoadTexture(const wchar_t* aTexturePath, bool aForceSRGB, bool aForceReload);
+		Texture* TryLoadTexture(const wchar_t* aTexturePath, bool aForceSRGB);
+
 		DXGI_FORMAT GetTextureFormat(struct ID3D11ShaderResourceView* aResourceView) const;
 		std::vector<std::unique_ptr<Texture>> myResourceViews;
 		void CreateErrorSquareTexture();
@@ -44,5 +68,8 @@ namespace Tga
 		ComPtr<ID3D11ShaderResourceView> myFailedResource;
 		ComPtr<ID3D11ShaderResourceView> myDefaultNormalMapResource;
 		std::unique_ptr<Texture> myWhiteSquareTexture;
+
+		std::vector<PendingRelease> myPendingReleases;
+		unsigned int myReleaseDelay = 0;
 	};
 }
\ No newline at end of file
@@ -7,6 +7,9 @@ Tga::Texture::Texture()
 {
 	myPath = L"undefined";
 	myIsFailedTexture = false;
+	myIsReleased = false;
+	myUseCount = 0;
+	myIsKeptLoaded = false;
 }
 
 Tga::Texture::~Texture()
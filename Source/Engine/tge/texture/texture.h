@@ -23,5 +23,9 @@ namespace Tga
 		Vector2ui myImageSize;
 		bool myIsFailedTexture;
 		bool myIsReleased;
+		// Uses from TextureManager::AcquireTexture not yet released
+		unsigned int myUseCount;
+		// Fetched with GetTexture by code that never releases it
+		bool myIsKeptLoaded;
 	};
 }
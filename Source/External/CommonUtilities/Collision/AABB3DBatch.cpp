@@ -0,0 +1,246 @@
+#include "AABB3DBatch.h"
+
+namespace CU
+{
+	namespace
+	{
+		struct SlabResult
+		{
+			SimdFloat myEntry;
+			SimdFloat myExit;
+		};
+
+		// Branchless slab test, the same math as IntersectionAABBRay with one ray or box per lane
+		inline SlabResult IntersectSlabs(SimdFloat aMinX, SimdFloat aMinY, SimdFloat aMinZ, SimdFloat aMaxX, SimdFloat aMaxY, SimdFloat aMaxZ,
+			SimdFloat aOriginX, SimdFloat aOriginY, SimdFloat aOriginZ, SimdFloat aInverseX, SimdFloat aInverseY, SimdFloat aInverseZ)
+		{
+			const SimdFloat x1 = (aMinX - aOriginX) * aInverseX;
+			const SimdFloat x2 = (aMaxX - aOriginX) * aInverseX;
+			const SimdFloat y1 = (aMinY - aOriginY) * aInverseY;
+			const SimdFloat y2 = (aMaxY - aOriginY) * aInverseY;
+			const SimdFloat z1 = (aMinZ - aOriginZ) * aInverseZ;
+			const SimdFloat z2 = (aMaxZ - aOriginZ) * aInverseZ;
+
+			SlabResult result;
+			result.myEntry = SimdMax(SimdMax(SimdMin(x1, x2), SimdMin(y1, y2)), SimdMax(SimdMin(z1, z2), SimdSet(0.0f)));
+			result.myExit = SimdMin(SimdMin(SimdMax(x1, x2), SimdMax(y1, y2)), SimdMax(z1, z2));
+			return result;
+		}
+	}
+
+	RayPacket::RayPacket()
+		: myActiveMask(0)
+	{
+		for (size_t lane = 0; lane < ourLaneCount; ++lane)
+		{
+			Clear(lane);
+		}
+	}
+
+	void RayPacket::Set(size_t aLane, const Rayf& aRay, float aMaxDistance)
+	{
+		const PrecomputedRay<float> ray(aRay);
+		myOriginX[aLane] = ray.myOrigin.x;
+		myOriginY[aLane] = ray.myOrigin.y;
+		myOriginZ[aLane] = ray.myOrigin.z;
+		myInverseX[aLane] = ray.myInverseDirection.x;
+		myInverseY[aLane] = ray.myInverseDirection.y;
+		myInverseZ[aLane] = ray.myInverseDirection.z;
+		myMaxDistance[aLane] = aMaxDistance;
+		myActiveMask |= 1u << aLane;
+	}
+
+	void RayPacket::Clear(size_t aLane)
+	{
+		// Entry distances are never negative, so a negative max distance never hits
+		myOriginX[aLane] = 0.0f;
+		myOriginY[aLane] = 0.0f;
+		myOriginZ[aLane] = 0.0f;
+		myInverseX[aLane] = 1.0f;
+		myInverseY[aLane] = 1.0f;
+		myInverseZ[aLane] = 1.0f;
+		myMaxDistance[aLane] = -1.0f;
+		myActiveMask &= ~(1u << aLane);
+	}
+
+	uint32_t AABB3DBatch::Add(const AABB3Df& aBox)
+	{
+		const uint32_t index = static_cast<uint32_t>(mySize++);
+		if (index == myMinX.size())
+		{
+			const size_t size = index + ourLaneCount;
+			myMinX.resize(size);
+			myMinY.resize(size);
+			myMinZ.resize(size);
+			myMaxX.resize(size);
+			myMaxY.resize(size);
+			myMaxZ.resize(size);
+		}
+
+		Set(index, aBox);
+		return index;
+	}
+
+	void AABB3DBatch::Set(uint32_t aIndex, const AABB3Df& aBox)
+	{
+		myMinX[aIndex] = aBox.GetMin().x;
+		myMinY[aIndex] = aBox.GetMin().y;
+		myMinZ[aIndex] = aBox.GetMin().z;
+		myMaxX[aIndex] = aBox.GetMax().x;
+		myMaxY[aIndex] = aBox.GetMax().y;
+		myMaxZ[aIndex] = aBox.GetMax().z;
+	}
+
+	void AABB3DBatch::Clear()
+	{
+		myMinX.clear();
+		myMinY.clear();
+		myMinZ.clear();
+		myMaxX.clear();
+		myMaxY.clear();
+		myMaxZ.clear();
+		mySize = 0;
+	}
+
+	uint32_t AABB3DBatch::GetRayMask(const PrecomputedRay<float>& aRay, float aMaxDistance, size_t aFirst) const
+	{
+		const SlabResult slabs = IntersectSlabs(
+			SimdLoad(&myMinX[aFirst]), SimdLoad(&myMinY[aFirst]), SimdLoad(&myMinZ[aFirst]),
+			SimdLoad(&myMaxX[aFirst]), SimdLoad(&myMaxY[aFirst]), SimdLoad(&myMaxZ[aFirst]),
+			SimdSet(aRay.myOrigin.x), SimdSet(aRay.myOrigin.y), SimdSet(aRay.myOrigin.z),
+			SimdSet(aRay.myInverseDirection.x), SimdSet(aRay.myInverseDirection.y), SimdSet(aRay.myInverseDirection.z));
+
+		const SimdFloat hit = SimdLessEqual(slabs.myEntry, slabs.myExit) & SimdLessEqual(slabs.myEntry, SimdSet(aMaxDistance));
+		return SimdMoveMask(hit) & GetValidMask(aFirst);
+	}
+
+	void AABB3DBatch::Raycast(const Rayf& aRay, float aMaxDistance, std::vector<uint32_t>& aOutIndices) const
+	{
+		aOutIndices.clear();
+
+		const PrecomputedRay<float> ray(aRay);
+		for (size_t first = 0; first < mySize; first += ourLaneCount)
+		{
+			uint32_t mask = GetRayMask(ray, aMaxDistance, first);
+			for (uint32_t lane = 0; mask != 0; ++lane, mask >>= 1)
+			{
+				if (mask & 1)
+				{
+					aOutIndices.push_back(static_cast<uint32_t>(first) + lane);
+				}
+			}
+		}
+	}
+
+	uint32_t AABB3DBatch::RaycastClosest(const Rayf& aRay, float aMaxDistance, float& aOutDistance) const
+	{
+		const PrecomputedRay<float> ray(aRay);
+		const SimdFloat originX = SimdSet(ray.myOrigin.x);
+		const SimdFloat originY = SimdSet(ray.myOrigin.y);
+		const SimdFloat originZ = SimdSet(ray.myOrigin.z);
+		const SimdFloat inverseX = SimdSet(ray.myInverseDirection.x);
+		const SimdFloat inverseY = SimdSet(ray.myInverseDirection.y);
+		const SimdFloat inverseZ = SimdSet(ray.myInverseDirection.z);
+
+		uint32_t closest = ourNoHit;
+		aOutDistance = aMaxDistance;
+		for (size_t first = 0; first < mySize; first += ourLaneCount)
+		{
+			const SlabResult slabs = IntersectSlabs(
+				SimdLoad(&myMinX[first]), SimdLoad(&myMinY[first]), SimdLoad(&myMinZ[first]),
+				SimdLoad(&myMaxX[first]), SimdLoad(&myMaxY[first]), SimdLoad(&myMaxZ[first]),
+				originX, originY, originZ, inverseX, inverseY, inverseZ);
+
+			const SimdFloat hit = SimdLessEqual(slabs.myEntry, slabs.myExit) & SimdLessEqual(slabs.myEntry, SimdSet(aOutDistance));
+			uint32_t mask = SimdMoveMask(hit) & GetValidMask(first);
+			if (mask == 0)
+			{
+				continue;
+			}
+
+			float entries[ourLaneCount];
+			SimdStore(entries, slabs.myEntry);
+			for (uint32_t lane = 0; mask != 0; ++lane, mask >>= 1)
+			{
+				if ((mask & 1) && (closest == ourNoHit || entries[lane] < aOutDistance))
+				{
+					closest = static_cast<uint32_t>(first) + lane;
+					aOutDistance = entries[lane];
+				}
+			}
+		}
+		return closest;
+	}
+
+	uint32_t AABB3DBatch::RaycastAny(const RayPacket& aPacket) const
+	{
+		const SimdFloat originX = SimdLoad(aPacket.myOriginX);
+		const SimdFloat originY = SimdLoad(aPacket.myOriginY);
+		const SimdFloat originZ = SimdLoad(aPacket.myOriginZ);
+		const SimdFloat inverseX = SimdLoad(aPacket.myInverseX);
+		const SimdFloat inverseY = SimdLoad(aPacket.myInverseY);
+		const SimdFloat inverseZ = SimdLoad(aPacket.myInverseZ);
+		const SimdFloat maxDistance = SimdLoad(aPacket.myMaxDistance);
+
+		uint32_t hitMask = 0;
+		for (size_t index = 0; index < mySize && hitMask != aPacket.myActiveMask; ++index)
+		{
+			const SlabResult slabs = IntersectSlabs(
+				SimdSet(myMinX[index]), SimdSet(myMinY[index]), SimdSet(myMinZ[index]),
+				SimdSet(myMaxX[index]), SimdSet(myMaxY[index]), SimdSet(myMaxZ[index]),
+				originX, originY, originZ, inverseX, inverseY, inverseZ);
+
+			hitMask |= SimdMoveMask(SimdLessEqual(slabs.myEntry, slabs.myExit) & SimdLessEqual(slabs.myEntry, maxDistance));
+		}
+		return hitMask & aPacket.myActiveMask;
+	}
+
+	void AABB3DBatch::RaycastClosest(const RayPacket& aPacket, uint32_t (&aOutIndices)[ourLaneCount], float (&aOutDistances)[ourLaneCount]) const
+	{
+		const SimdFloat originX = SimdLoad(aPacket.myOriginX);
+		const SimdFloat originY = SimdLoad(aPacket.myOriginY);
+		const SimdFloat originZ = SimdLoad(aPacket.myOriginZ);
+		const SimdFloat inverseX = SimdLoad(aPacket.myInverseX);
+		const SimdFloat inverseY = SimdLoad(aPacket.myInverseY);
+		const SimdFloat inverseZ = SimdLoad(aPacket.myInverseZ);
+
+		for (size_t lane = 0; lane < ourLaneCount; ++lane)
+		{
+			aOutIndices[lane] = ourNoHit;
+		}
+
+		// Every box narrows the distance each ray still has to beat
+		SimdFloat closest = SimdLoad(aPacket.myMaxDistance);
+		for (size_t index = 0; index < mySize; ++index)
+		{
+			const SlabResult slabs = IntersectSlabs(
+				SimdSet(myMinX[index]), SimdSet(myMinY[index]), SimdSet(myMinZ[index]),
+				SimdSet(myMaxX[index]), SimdSet(myMaxY[index]), SimdSet(myMaxZ[index]),
+				originX, originY, originZ, inverseX, inverseY, inverseZ);
+
+			const SimdFloat hit = SimdLessEqual(slabs.myEntry, slabs.myExit) & SimdLessEqual(slabs.myEntry, closest);
+			uint32_t mask = SimdMoveMask(hit);
+			if (mask == 0)
+			{
+				continue;
+			}
+
+			closest = SimdSelect(hit, slabs.myEntry, closest);
+			for (uint32_t lane = 0; mask != 0; ++lane, mask >>= 1)
+			{
+				if (mask & 1)
+				{
+					aOutIndices[lane] = static_cast<uint32_t>(index);
+				}
+			}
+		}
+
+		SimdStore(aOutDistances, closest);
+	}
+
+	uint32_t AABB3DBatch::GetValidMask(size_t aFirst) const
+	{
+		const size_t valid = mySize - aFirst;
+		return valid >= ourLaneCount ? (1u << ourLaneCount) - 1 : (1u << valid) - 1;
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "AABB3D.hpp"
+#include "Intersection.hpp"
+#include "Ray.hpp"
+#include <CommonUtilities/Math/SimdFloat.hpp>
+
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+namespace CU
+{
+	// SimdFloat::ourLaneCount rays in structure of arrays layout, for coherent rays like the fan of a
+	// line of sight check. Lanes that are not set never hit anything.
+	class RayPacket
+	{
+	public:
+		static constexpr size_t ourLaneCount = SimdFloat::ourLaneCount;
+
+		RayPacket();
+
+		// Hits further away than aMaxDistance along the ray are ignored
+		void Set(size_t aLane, const Rayf& aRay, float aMaxDistance = FLT_MAX);
+		void Clear(size_t aLane);
+
+		uint32_t GetActiveMask() const { return myActiveMask; }
+
+	private:
+		friend class AABB3DBatch;
+
+		alignas(32) float myOriginX[ourLaneCount];
+		alignas(32) float myOriginY[ourLaneCount];
+		alignas(32) float myOriginZ[ourLaneCount];
+		alignas(32) float myInverseX[ourLaneCount];
+		alignas(32) float myInverseY[ourLaneCount];
+		alignas(32) float myInverseZ[ourLaneCount];
+		alignas(32) float myMaxDistance[ourLaneCount];
+		uint32_t myActiveMask;
+	};
+
+	// AABB3Dfs in structure of arrays layout, ray tests run on SimdFloat::ourLaneCount boxes per instruction.
+	// Same rules as IntersectionAABBRay: touching counts and boxes behind the ray's origin are missed.
+	class AABB3DBatch
+	{
+	public:
+		static constexpr size_t ourLaneCount = SimdFloat::ourLaneCount;
+		static constexpr uint32_t ourNoHit = UINT32_MAX;
+
+		// Returns the index used in the results
+		uint32_t Add(const AABB3Df& aBox);
+		void Set(uint32_t aIndex, const AABB3Df& aBox);
+		void Clear();
+
+		// Bit n is set when the ray hits box aFirst + n within aMaxDistance. aFirst has to be a multiple of ourLaneCount.
+		uint32_t GetRayMask(const PrecomputedRay<float>& aRay, float aMaxDistance, size_t aFirst) const;
+
+		// Every box the ray hits within aMaxDistance, in index order. Replaces the content of aOutIndices.
+		void Raycast(const Rayf& aRay, float aMaxDistance, std::vector<uint32_t>& aOutIndices) const;
+
+		// The box hit closest to the ray's origin, ourNoHit if none
+		uint32_t RaycastClosest(const Rayf& aRay, float aMaxDistance, float& aOutDistance) const;
+
+		// Bit n is set when ray n of the packet hits any box, stops as soon as every active ray has hit
+		uint32_t RaycastAny(const RayPacket& aPacket) const;
+
+		// Closest box for every ray of the packet, ourNoHit for rays that hit nothing
+		void RaycastClosest(const RayPacket& aPacket, uint32_t (&aOutIndices)[ourLaneCount], float (&aOutDistances)[ourLaneCount]) const;
+
+		size_t size() const { return mySize; }
+
+	private:
+		uint32_t GetValidMask(size_t aFirst) const;
+
+		// Padded to a multiple of ourLaneCount, the padding lanes are masked away
+		std::vector<float> myMinX;
+		std::vector<float> myMinY;
+		std::vector<float> myMinZ;
+		std::vector<float> myMaxX;
+		std::vector<float> myMaxY;
+		std::vector<float> myMaxZ;
+		size_t mySize = 0;
+	};
+}
+
+namespace CommonUtilities = CU;
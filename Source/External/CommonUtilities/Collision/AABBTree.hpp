@@ -0,0 +1,554 @@
+#pragma once
+#include <CommonUtilities/Math/Vector3.hpp>
+#include "AABB3D.hpp"
+#include "Intersection.hpp"
+#include "PlaneVolume.hpp"
+#include "Ray.hpp"
+
+#include <cassert>
+#include <vector>
+
+namespace CU
+{
+	// Dynamic bounding volume hierarchy. Every leaf stores a fattened copy of its box, so objects that
+	// move a little stay inside it and Move does not have to touch the tree. Insert picks the sibling
+	// that grows the total surface area least and rotations keep the tree balanced, so insert, remove
+	// and move are O(log n). Queries are read only, any number of threads may query while nobody writes.
+	template<class T, class Data = void*>
+	class AABBTree
+	{
+	public:
+		static constexpr int ourNullNode = -1;
+
+		// aMargin is how much leaf boxes are fattened on every side, aDisplacementScale how far ahead of
+		// a move's displacement the box is extended
+		explicit AABBTree(T aMargin = T(0.1), T aDisplacementScale = T(2));
+		~AABBTree() = default;
+
+		// Returns the proxy ID used for every other call
+		int Insert(const AABB3D<T>& aBox, const Data& aData);
+		void Remove(int aProxy);
+
+		// Returns true if the leaf had to be reinserted because aBox left its fat box
+		bool Move(int aProxy, const AABB3D<T>& aBox, const Vector3<T>& aDisplacement = Vector3<T>());
+
+		const Data& GetData(int aProxy) const;
+		const AABB3D<T>& GetFatBox(int aProxy) const;
+
+		// aCallback(int aProxy) for every leaf whose fat box overlaps aBox, return false to stop the query
+		template<class Callback>
+		void QueryOverlap(const AABB3D<T>& aBox, Callback&& aCallback) const;
+
+		// aCallback(int aProxy) for every leaf whose fat box IntersectionAABBRay hits, return false to stop
+		template<class Callback>
+		void QueryRay(const Ray<T>& aRay, Callback&& aCallback) const;
+
+		// aCallback(int aProxy) for every leaf whose fat box is not fully outside one of the planes,
+		// subtrees fully inside all planes are reported without further tests. Return false to stop.
+		template<class Callback>
+		void QueryFrustum(const PlaneVolume<T>& aFrustum, Callback&& aCallback) const;
+
+		int GetHeight() const;
+		size_t size() const { return myProxyCount; }
+
+	private:
+		// Deep enough for any balanced tree that fits in memory
+		static constexpr int ourStackSize = 256;
+
+		struct Node
+		{
+			AABB3D<T> myBox;
+			Data myData = Data();
+			int myParent = ourNullNode;  // Next free node while on the free list
+			int myChild1 = ourNullNode;
+			int myChild2 = ourNullNode;
+			int myHeight = -1;           // Leaves are 0, free nodes -1
+
+			bool IsLeaf() const { return myChild1 == ourNullNode; }
+		};
+
+		int AllocateNode();
+		void FreeNode(int aNode);
+		void InsertLeaf(int aLeaf);
+		void RemoveLeaf(int aLeaf);
+		int Balance(int aNode);
+		void Refit(int aNode);
+
+		template<class Callback>
+		bool ReportSubtree(int aNode, Callback& aCallback) const;
+
+		static AABB3D<T> Union(const AABB3D<T>& aFirst, const AABB3D<T>& aSecond);
+		static T GetArea(const AABB3D<T>& aBox);
+		static bool Contains(const AABB3D<T>& aOuter, const AABB3D<T>& aInner);
+		static bool Overlaps(const AABB3D<T>& aFirst, const AABB3D<T>& aSecond);
+
+		std::vector<Node> myNodes;
+		int myRoot = ourNullNode;
+		int myFreeList = ourNullNode;
+		size_t myProxyCount = 0;
+		T myMargin;
+		T myDisplacementScale;
+	};
+
+	using AABBTreef = AABBTree<float>;
+
+	template<class T, class Data>
+	inline AABBTree<T, Data>::AABBTree(T aMargin, T aDisplacementScale)
+		: myMargin(aMargin)
+		, myDisplacementScale(aDisplacementScale)
+	{
+	}
+
+	template<class T, class Data>
+	inline int AABBTree<T, Data>::Insert(const AABB3D<T>& aBox, const Data& aData)
+	{
+		const int leaf = AllocateNode();
+		const Vector3<T> margin(myMargin, myMargin, myMargin);
+		myNodes[leaf].myBox.InitWithMinAndMax(aBox.GetMin() - margin, aBox.GetMax() + margin);
+		myNodes[leaf].myData = aData;
+		myNodes[leaf].myHeight = 0;
+
+		InsertLeaf(leaf);
+		++myProxyCount;
+		return leaf;
+	}
+
+	template<class T, class Data>
+	inline void AABBTree<T, Data>::Remove(int aProxy)
+	{
+		assert(aProxy >= 0 && aProxy < static_cast<int>(myNodes.size()) && myNodes[aProxy].IsLeaf());
+
+		RemoveLeaf(aProxy);
+		FreeNode(aProxy);
+		--myProxyCount;
+	}
+
+	template<class T, class Data>
+	inline bool AABBTree<T, Data>::Move(int aProxy, const AABB3D<T>& aBox, const Vector3<T>& aDisplacement)
+	{
+		assert(aProxy >= 0 && aProxy < static_cast<int>(myNodes.size()) && myNodes[aProxy].IsLeaf());
+
+		if (Contains(myNodes[aProxy].myBox, aBox))
+		{
+			return false;
+		}
+
+		RemoveLeaf(aProxy);
+
+		// Fatten and extend in the direction of movement so the next few moves fit as well
+		const Vector3<T> margin(myMargin, myMargin, myMargin);
+		Vector3<T> min = aBox.GetMin() - margin;
+		Vector3<T> max = aBox.GetMax() + margin;
+		const Vector3<T> displacement = aDisplacement * myDisplacementScale;
+		min = MinV(min, min + displacement);
+		max = MaxV(max, max + displacement);
+		myNodes[aProxy].myBox.InitWithMinAndMax(min, max);
+
+		InsertLeaf(aProxy);
+		return true;
+	}
+
+	template<class T, class Data>
+	inline const Data& AABBTree<T, Data>::GetData(int aProxy) const
+	{
+		return myNodes[aProxy].myData;
+	}
+
+	template<class T, class Data>
+	inline const AABB3D<T>& AABBTree<T, Data>::GetFatBox(int aProxy) const
+	{
+		return myNodes[aProxy].myBox;
+	}
+
+	template<class T, class Data>
+	template<class Callback>
+	inline void AABBTree<T, Data>::QueryOverlap(const AABB3D<T>& aBox, Callback&& aCallback) const
+	{
+		int stack[ourStackSize];
+		int stackSize = 0;
+		if (myRoot != ourNullNode)
+		{
+			stack[stackSize++] = myRoot;
+		}
+
+		while (stackSize > 0)
+		{
+			const Node& node = myNodes[stack[--stackSize]];
+			if (!Overlaps(node.myBox, aBox))
+			{
+				continue;
+			}
+
+			if (node.IsLeaf())
+			{
+				if (!aCallback(static_cast<int>(&node - myNodes.data())))
+				{
+					return;
+				}
+			}
+			else
+			{
+				assert(stackSize + 2 <= ourStackSize);
+				stack[stackSize++] = node.myChild1;
+				stack[stackSize++] = node.myChild2;
+			}
+		}
+	}
+
+	template<class T, class Data>
+	template<class Callback>
+	inline void AABBTree<T, Data>::QueryRay(const Ray<T>& aRay, Callback&& aCallback) const
+	{
+		const PrecomputedRay<T> ray(aRay);
+		T distance;
+
+		int stack[ourStackSize];
+		int stackSize = 0;
+		if (myRoot != ourNullNode)
+		{
+			stack[stackSize++] = myRoot;
+		}
+
+		while (stackSize > 0)
+		{
+			const Node& node = myNodes[stack[--stackSize]];
+			if (!IntersectionAABBRay(node.myBox, ray, distance))
+			{
+				continue;
+			}
+
+			if (node.IsLeaf())
+			{
+				if (!aCallback(static_cast<int>(&node - myNodes.data())))
+				{
+					return;
+				}
+			}
+			else
+			{
+				assert(stackSize + 2 <= ourStackSize);
+				stack[stackSize++] = node.myChild1;
+				stack[stackSize++] = node.myChild2;
+			}
+		}
+	}
+
+	template<class T, class Data>
+	template<class Callback>
+	inline void AABBTree<T, Data>::QueryFrustum(const PlaneVolume<T>& aFrustum, Callback&& aCallback) const
+	{
+		int stack[ourStackSize];
+		int stackSize = 0;
+		if (myRoot != ourNullNode)
+		{
+			stack[stackSize++] = myRoot;
+		}
+
+		while (stackSize > 0)
+		{
+			const int nodeIndex = stack[--stackSize];
+			const Node& node = myNodes[nodeIndex];
+
+			const VolumeSide side = aFrustum.Classify(node.myBox);
+			if (side == VolumeSide::Outside)
+			{
+				continue;
+			}
+
+			if (side == VolumeSide::Inside || node.IsLeaf())
+			{
+				if (!ReportSubtree(nodeIndex, aCallback))
+				{
+					return;
+				}
+			}
+			else
+			{
+				assert(stackSize + 2 <= ourStackSize);
+				stack[stackSize++] = node.myChild1;
+				stack[stackSize++] = node.myChild2;
+			}
+		}
+	}
+
+	template<class T, class Data>
+	inline int AABBTree<T, Data>::GetHeight() const
+	{
+		return myRoot == ourNullNode ? 0 : myNodes[myRoot].myHeight;
+	}
+
+	template<class T, class Data>
+	template<class Callback>
+	inline bool AABBTree<T, Data>::ReportSubtree(int aNode, Callback& aCallback) const
+	{
+		int stack[ourStackSize];
+		int stackSize = 0;
+		stack[stackSize++] = aNode;
+
+		while (stackSize > 0)
+		{
+			const int nodeIndex = stack[--stackSize];
+			const Node& node = myNodes[nodeIndex];
+			if (node.IsLeaf())
+			{
+				if (!aCallback(nodeIndex))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				assert(stackSize + 2 <= ourStackSize);
+				stack[stackSize++] = node.myChild1;
+				stack[stackSize++] = node.myChild2;
+			}
+		}
+		return true;
+	}
+
+	template<class T, class Data>
+	inline int AABBTree<T, Data>::AllocateNode()
+	{
+		if (myFreeList == ourNullNode)
+		{
+			myNodes.emplace_back();
+			return static_cast<int>(myNodes.size()) - 1;
+		}
+
+		const int node = myFreeList;
+		myFreeList = myNodes[node].myParent;
+		myNodes[node] = Node();
+		return node;
+	}
+
+	template<class T, class Data>
+	inline void AABBTree<T, Data>::FreeNode(int aNode)
+	{
+		myNodes[aNode] = Node();
+		myNodes[aNode].myParent = myFreeList;
+		myFreeList = aNode;
+	}
+
+	template<class T, class Data>
+	inline void AABBTree<T, Data>::InsertLeaf(int aLeaf)
+	{
+		if (myRoot == ourNullNode)
+		{
+			myRoot = aLeaf;
+			myNodes[aLeaf].myParent = ourNullNode;
+			return;
+		}
+
+		// Walk down to the sibling whose merge with the leaf costs the least surface area
+		const AABB3D<T> leafBox = myNodes[aLeaf].myBox;
+		int index = myRoot;
+		while (!myNodes[index].IsLeaf())
+		{
+			const Node& node = myNodes[index];
+			const T area = GetArea(node.myBox);
+			const T combinedArea = GetArea(Union(node.myBox, leafBox));
+
+			// Cost of making a new parent for this node and the leaf, and the cost pushed down to the children
+			const T cost = T(2) * combinedArea;
+			const T inheritanceCost = T(2) * (combinedArea - area);
+
+			T childCosts[2];
+			const int children[2] = { node.myChild1, node.myChild2 };
+			for (int child = 0; child < 2; ++child)
+			{
+				const Node& childNode = myNodes[children[child]];
+				const T unionArea = GetArea(Union(leafBox, childNode.myBox));
+				childCosts[child] = childNode.IsLeaf() ? unionArea + inheritanceCost : unionArea - GetArea(childNode.myBox) + inheritanceCost;
+			}
+
+			if (cost < childCosts[0] && cost < childCosts[1])
+			{
+				break;
+			}
+			index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+		}
+
+		const int sibling = index;
+		const int oldParent = myNodes[sibling].myParent;
+		const int newParent = AllocateNode();
+		myNodes[newParent].myParent = oldParent;
+		myNodes[newParent].myBox = Union(leafBox, myNodes[sibling].myBox);
+		myNodes[newParent].myHeight = myNodes[sibling].myHeight + 1;
+		myNodes[newParent].myChild1 = sibling;
+		myNodes[newParent].myChild2 = aLeaf;
+		myNodes[sibling].myParent = newParent;
+		myNodes[aLeaf].myParent = newParent;
+
+		if (oldParent == ourNullNode)
+		{
+			myRoot = newParent;
+		}
+		else if (myNodes[oldParent].myChild1 == sibling)
+		{
+			myNodes[oldParent].myChild1 = newParent;
+		}
+		else
+		{
+			myNodes[oldParent].myChild2 = newParent;
+		}
+
+		Refit(myNodes[aLeaf].myParent);
+	}
+
+	template<class T, class Data>
+	inline void AABBTree<T, Data>::RemoveLeaf(int aLeaf)
+	{
+		if (aLeaf == myRoot)
+		{
+			myRoot = ourNullNode;
+			return;
+		}
+
+		const int parent = myNodes[aLeaf].myParent;
+		const int grandParent = myNodes[parent].myParent;
+		const int sibling = myNodes[parent].myChild1 == aLeaf ? myNodes[parent].myChild2 : myNodes[parent].myChild1;
+
+		// The sibling takes the parent's place
+		if (grandParent == ourNullNode)
+		{
+			myRoot = sibling;
+			myNodes[sibling].myParent = ourNullNode;
+			FreeNode(parent);
+			return;
+		}
+
+		if (myNodes[grandParent].myChild1 == parent)
+		{
+			myNodes[grandParent].myChild1 = sibling;
+		}
+		else
+		{
+			myNodes[grandParent].myChild2 = sibling;
+		}
+		myNodes[sibling].myParent = grandParent;
+		FreeNode(parent);
+
+		Refit(grandParent);
+	}
+
+	template<class T, class Data>
+	inline void AABBTree<T, Data>::Refit(int aNode)
+	{
+		int index = aNode;
+		while (index != ourNullNode)
+		{
+			index = Balance(index);
+
+			Node& node = myNodes[index];
+			const Node& child1 = myNodes[node.myChild1];
+			const Node& child2 = myNodes[node.myChild2];
+			node.myHeight = 1 + (child1.myHeight > child2.myHeight ? child1.myHeight : child2.myHeight);
+			node.myBox = Union(child1.myBox, child2.myBox);
+
+			index = node.myParent;
+		}
+	}
+
+	template<class T, class Data>
+	inline int AABBTree<T, Data>::Balance(int aNode)
+	{
+		// Rotates the taller child up when the children's heights differ by more than one,
+		// returns the node that now sits where aNode was
+		Node& a = myNodes[aNode];
+		if (a.IsLeaf() || a.myHeight < 2)
+		{
+			return aNode;
+		}
+
+		const int indexB = a.myChild1;
+		const int indexC = a.myChild2;
+		const int balance = myNodes[indexC].myHeight - myNodes[indexB].myHeight;
+		if (balance >= -1 && balance <= 1)
+		{
+			return aNode;
+		}
+
+		// Rotate the taller child up, its taller grandchild stays below it and the other one moves to aNode
+		const int indexUp = balance > 0 ? indexC : indexB;
+		const int indexStay = balance > 0 ? indexB : indexC;
+		Node& up = myNodes[indexUp];
+		const int indexF = up.myChild1;
+		const int indexG = up.myChild2;
+
+		up.myChild1 = aNode;
+		up.myParent = a.myParent;
+		a.myParent = indexUp;
+
+		if (up.myParent == ourNullNode)
+		{
+			myRoot = indexUp;
+		}
+		else if (myNodes[up.myParent].myChild1 == aNode)
+		{
+			myNodes[up.myParent].myChild1 = indexUp;
+		}
+		else
+		{
+			myNodes[up.myParent].myChild2 = indexUp;
+		}
+
+		const bool isFTaller = myNodes[indexF].myHeight > myNodes[indexG].myHeight;
+		const int indexTaller = isFTaller ? indexF : indexG;
+		const int indexShorter = isFTaller ? indexG : indexF;
+
+		up.myChild2 = indexTaller;
+		if (balance > 0)
+		{
+			a.myChild2 = indexShorter;
+		}
+		else
+		{
+			a.myChild1 = indexShorter;
+		}
+		myNodes[indexShorter].myParent = aNode;
+
+		const Node& stay = myNodes[indexStay];
+		const Node& shorter = myNodes[indexShorter];
+		a.myBox = Union(stay.myBox, shorter.myBox);
+		a.myHeight = 1 + (stay.myHeight > shorter.myHeight ? stay.myHeight : shorter.myHeight);
+
+		const Node& taller = myNodes[indexTaller];
+		up.myBox = Union(a.myBox, taller.myBox);
+		up.myHeight = 1 + (a.myHeight > taller.myHeight ? a.myHeight : taller.myHeight);
+
+		return indexUp;
+	}
+
+	template<class T, class Data>
+	inline AABB3D<T> AABBTree<T, Data>::Union(const AABB3D<T>& aFirst, const AABB3D<T>& aSecond)
+	{
+		return AABB3D<T>(MinV(aFirst.GetMin(), aSecond.GetMin()), MaxV(aFirst.GetMax(), aSecond.GetMax()));
+	}
+
+	template<class T, class Data>
+	inline T AABBTree<T, Data>::GetArea(const AABB3D<T>& aBox)
+	{
+		const Vector3<T> size = aBox.GetMax() - aBox.GetMin();
+		return T(2) * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	template<class T, class Data>
+	inline bool AABBTree<T, Data>::Contains(const AABB3D<T>& aOuter, const AABB3D<T>& aInner)
+	{
+		return aOuter.IsInside(aInner.GetMin()) && aOuter.IsInside(aInner.GetMax());
+	}
+
+	template<class T, class Data>
+	inline bool AABBTree<T, Data>::Overlaps(const AABB3D<T>& aFirst, const AABB3D<T>& aSecond)
+	{
+		const Vector3<T>& firstMin = aFirst.GetMin();
+		const Vector3<T>& firstMax = aFirst.GetMax();
+		const Vector3<T>& secondMin = aSecond.GetMin();
+		const Vector3<T>& secondMax = aSecond.GetMax();
+		return firstMin.x <= secondMax.x && firstMax.x >= secondMin.x
+			&& firstMin.y <= secondMax.y && firstMax.y >= secondMin.y
+			&& firstMin.z <= secondMax.z && firstMax.z >= secondMin.z;
+	}
+}
+
+namespace CommonUtilities = CU;
@@ -0,0 +1,285 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace CU
+{
+	// Remembers which pairs of handles touched last frame and turns this frame's touching pairs into
+	// begin, persist and end events. Handles are anything small, comparable and hashable: collider
+	// pointers, broadphase proxy IDs or indices into arrays of Sphere or AABB3D.
+	// Each frame: BeginFrame, Add every touching pair from any broadphase and narrow phase, EndFrame,
+	// then iterate the event arrays. The pairs live in an open addressed table with linear probing.
+	template<class Handle>
+	class ContactPairCache
+	{
+	public:
+		// Pairs are stored with myFirst < mySecond, whatever order they were added in
+		struct Pair
+		{
+			Handle myFirst;
+			Handle mySecond;
+		};
+
+		ContactPairCache();
+		~ContactPairCache() = default;
+
+		void BeginFrame();
+
+		// Reports a pair as touching this frame, adding the same pair twice in a frame is fine.
+		// Returns true when the pair was not touching last frame.
+		bool Add(const Handle& aFirst, const Handle& aSecond);
+
+		// Adds the pair when aTest(aFirst, aSecond) returns true, for running the narrow phase inline
+		template<class Test>
+		bool AddIfTouching(const Handle& aFirst, const Handle& aSecond, Test&& aTest);
+
+		// Pairs from last frame that were not added again become end events
+		void EndFrame();
+
+		// Events of the last finished frame, in no particular order
+		const std::vector<Pair>& GetBegin() const { return myBegin; }
+		const std::vector<Pair>& GetPersist() const { return myPersist; }
+		const std::vector<Pair>& GetEnd() const { return myEnd; }
+
+		bool Contains(const Handle& aFirst, const Handle& aSecond) const;
+
+		// Forgets every pair without sending end events
+		void Clear();
+
+		size_t size() const { return myCount; }
+
+	private:
+		struct Slot
+		{
+			Handle myFirst = Handle();
+			Handle mySecond = Handle();
+			// Frame the pair was last added, 0 is an empty slot
+			uint32_t myFrame = 0;
+		};
+
+		static size_t GetHash(const Handle& aFirst, const Handle& aSecond);
+		static void Order(Handle& aFirst, Handle& aSecond);
+
+		size_t FindSlot(const Handle& aFirst, const Handle& aSecond) const;
+		void RemoveSlot(size_t aSlot);
+		void Grow();
+
+		std::vector<Slot> mySlots;
+		std::vector<Pair> myBegin;
+		std::vector<Pair> myPersist;
+		std::vector<Pair> myEnd;
+		size_t myCount = 0;
+		size_t myMask = 0;
+		uint32_t myFrame = 1;
+		bool myIsInFrame = false;
+	};
+
+	template<class Handle>
+	inline ContactPairCache<Handle>::ContactPairCache()
+	{
+		mySlots.resize(64);
+		myMask = mySlots.size() - 1;
+	}
+
+	template<class Handle>
+	inline void ContactPairCache<Handle>::BeginFrame()
+	{
+		assert(!myIsInFrame && "ContactPairCache::BeginFrame called twice without EndFrame");
+		myIsInFrame = true;
+		myBegin.clear();
+		myPersist.clear();
+		myEnd.clear();
+
+		// 0 marks empty slots. After wrapping every stored pair is restamped so none looks current.
+		if (++myFrame == 0)
+		{
+			myFrame = 2;
+			for (Slot& slot : mySlots)
+			{
+				if (slot.myFrame != 0)
+				{
+					slot.myFrame = 1;
+				}
+			}
+		}
+	}
+
+	template<class Handle>
+	inline bool ContactPairCache<Handle>::Add(const Handle& aFirst, const Handle& aSecond)
+	{
+		assert(myIsInFrame && "ContactPairCache::Add called outside BeginFrame and EndFrame");
+
+		Handle first = aFirst;
+		Handle second = aSecond;
+		Order(first, second);
+
+		// Kept at most half full so probes stay short
+		if ((myCount + 1) * 2 > mySlots.size())
+		{
+			Grow();
+		}
+
+		size_t index = GetHash(first, second) & myMask;
+		for (;; index = (index + 1) & myMask)
+		{
+			Slot& slot = mySlots[index];
+			if (slot.myFrame == 0)
+			{
+				slot.myFirst = first;
+				slot.mySecond = second;
+				slot.myFrame = myFrame;
+				++myCount;
+				myBegin.push_back({ first, second });
+				return true;
+			}
+			if (slot.myFirst == first && slot.mySecond == second)
+			{
+				if (slot.myFrame != myFrame)
+				{
+					slot.myFrame = myFrame;
+					myPersist.push_back({ first, second });
+				}
+				return false;
+			}
+		}
+	}
+
+	template<class Handle>
+	template<class Test>
+	inline bool ContactPairCache<Handle>::AddIfTouching(const Handle& aFirst, const Handle& aSecond, Test&& aTest)
+	{
+		if (!aTest(aFirst, aSecond))
+		{
+			return false;
+		}
+		return Add(aFirst, aSecond);
+	}
+
+	template<class Handle>
+	inline void ContactPairCache<Handle>::EndFrame()
+	{
+		assert(myIsInFrame && "ContactPairCache::EndFrame called without BeginFrame");
+		myIsInFrame = false;
+
+		// Removing shifts later slots back into the hole, so the same slot is looked at again
+		for (size_t index = 0; index < mySlots.size();)
+		{
+			Slot& slot = mySlots[index];
+			if (slot.myFrame != 0 && slot.myFrame != myFrame)
+			{
+				myEnd.push_back({ slot.myFirst, slot.mySecond });
+				RemoveSlot(index);
+				continue;
+			}
+			++index;
+		}
+	}
+
+	template<class Handle>
+	inline bool ContactPairCache<Handle>::Contains(const Handle& aFirst, const Handle& aSecond) const
+	{
+		Handle first = aFirst;
+		Handle second = aSecond;
+		Order(first, second);
+		return FindSlot(first, second) != mySlots.size();
+	}
+
+	template<class Handle>
+	inline void ContactPairCache<Handle>::Clear()
+	{
+		for (Slot& slot : mySlots)
+		{
+			slot = Slot();
+		}
+		myBegin.clear();
+		myPersist.clear();
+		myEnd.clear();
+		myCount = 0;
+	}
+
+	template<class Handle>
+	inline size_t ContactPairCache<Handle>::GetHash(const Handle& aFirst, const Handle& aSecond)
+	{
+		// Pointers and small indices hash to themselves, mix the bits so the low ones are all used
+		uint64_t hash = static_cast<uint64_t>(std::hash<Handle>()(aFirst)) * 0x9E3779B97F4A7C15ull;
+		hash ^= static_cast<uint64_t>(std::hash<Handle>()(aSecond)) + 0x7F4A7C159E3779B9ull + (hash << 6) + (hash >> 2);
+		hash ^= hash >> 31;
+		hash *= 0xBF58476D1CE4E5B9ull;
+		hash ^= hash >> 29;
+		return static_cast<size_t>(hash);
+	}
+
+	template<class Handle>
+	inline void ContactPairCache<Handle>::Order(Handle& aFirst, Handle& aSecond)
+	{
+		if (std::less<Handle>()(aSecond, aFirst))
+		{
+			std::swap(aFirst, aSecond);
+		}
+	}
+
+	template<class Handle>
+	inline size_t ContactPairCache<Handle>::FindSlot(const Handle& aFirst, const Handle& aSecond) const
+	{
+		for (size_t index = GetHash(aFirst, aSecond) & myMask;; index = (index + 1) & myMask)
+		{
+			const Slot& slot = mySlots[index];
+			if (slot.myFrame == 0)
+			{
+				return mySlots.size();
+			}
+			if (slot.myFirst == aFirst && slot.mySecond == aSecond)
+			{
+				return index;
+			}
+		}
+	}
+
+	template<class Handle>
+	inline void ContactPairCache<Handle>::RemoveSlot(size_t aSlot)
+	{
+		// Backward shift deletion: move later slots of the same probe run into the hole while that
+		// does not put them before their home slot, so lookups never need tombstones
+		size_t hole = aSlot;
+		for (size_t index = (hole + 1) & myMask; mySlots[index].myFrame != 0; index = (index + 1) & myMask)
+		{
+			const size_t home = GetHash(mySlots[index].myFirst, mySlots[index].mySecond) & myMask;
+			const size_t distanceToHole = (index - hole) & myMask;
+			const size_t distanceToHome = (index - home) & myMask;
+			if (distanceToHome >= distanceToHole)
+			{
+				mySlots[hole] = mySlots[index];
+				hole = index;
+			}
+		}
+		mySlots[hole] = Slot();
+		--myCount;
+	}
+
+	template<class Handle>
+	inline void ContactPairCache<Handle>::Grow()
+	{
+		std::vector<Slot> oldSlots(mySlots.size() * 2);
+		oldSlots.swap(mySlots);
+		myMask = mySlots.size() - 1;
+
+		for (const Slot& slot : oldSlots)
+		{
+			if (slot.myFrame == 0)
+			{
+				continue;
+			}
+			size_t index = GetHash(slot.myFirst, slot.mySecond) & myMask;
+			while (mySlots[index].myFrame != 0)
+			{
+				index = (index + 1) & myMask;
+			}
+			mySlots[index] = slot;
+		}
+	}
+}
+
+namespace CommonUtilities = CU;
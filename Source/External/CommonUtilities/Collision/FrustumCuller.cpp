@@ -0,0 +1,132 @@
+#include "FrustumCuller.h"
+#include <CommonUtilities/Math/SimdFloat.hpp>
+
+#include <cmath>
+
+namespace CU
+{
+	FrustumCuller::FrustumCuller(const PlaneVolumef& aVolume)
+	{
+		Init(aVolume);
+	}
+
+	void FrustumCuller::Init(const PlaneVolumef& aVolume)
+	{
+		myNormalX.clear();
+		myNormalY.clear();
+		myNormalZ.clear();
+		myDistance.clear();
+
+		for (const Planef& plane : aVolume.GetPlanes())
+		{
+			Vector3f normal = plane.GetNormal();
+			normal.Normalize();
+			myNormalX.push_back(normal.x);
+			myNormalY.push_back(normal.y);
+			myNormalZ.push_back(normal.z);
+			myDistance.push_back(normal.Dot(plane.GetPointOnPlane()));
+		}
+	}
+
+	void FrustumCuller::CullSpheres(const float* aCenterX, const float* aCenterY, const float* aCenterZ, const float* aRadius, size_t aCount, std::vector<uint32_t>& aOutVisible) const
+	{
+		aOutVisible.clear();
+
+		constexpr size_t laneCount = SimdFloat::ourLaneCount;
+		const size_t planeCount = myDistance.size();
+		const uint32_t allLanes = (1u << laneCount) - 1;
+
+		size_t first = 0;
+		for (; first + laneCount <= aCount; first += laneCount)
+		{
+			const SimdFloat centerX = SimdLoad(aCenterX + first);
+			const SimdFloat centerY = SimdLoad(aCenterY + first);
+			const SimdFloat centerZ = SimdLoad(aCenterZ + first);
+			const SimdFloat radius = SimdLoad(aRadius + first);
+
+			// Planes are broadcast, each lane is one sphere
+			uint32_t outside = 0;
+			for (size_t plane = 0; plane < planeCount && outside != allLanes; ++plane)
+			{
+				const SimdFloat distance = SimdSet(myNormalX[plane]) * centerX + SimdSet(myNormalY[plane]) * centerY + SimdSet(myNormalZ[plane]) * centerZ - SimdSet(myDistance[plane]);
+				outside |= SimdMoveMask(SimdGreater(distance, radius));
+			}
+
+			uint32_t visible = ~outside & allLanes;
+			for (uint32_t lane = 0; visible != 0; ++lane, visible >>= 1)
+			{
+				if (visible & 1)
+				{
+					aOutVisible.push_back(static_cast<uint32_t>(first) + lane);
+				}
+			}
+		}
+
+		for (; first < aCount; ++first)
+		{
+			bool isOutside = false;
+			for (size_t plane = 0; plane < planeCount && !isOutside; ++plane)
+			{
+				const float distance = myNormalX[plane] * aCenterX[first] + myNormalY[plane] * aCenterY[first] + myNormalZ[plane] * aCenterZ[first] - myDistance[plane];
+				isOutside = distance > aRadius[first];
+			}
+			if (!isOutside)
+			{
+				aOutVisible.push_back(static_cast<uint32_t>(first));
+			}
+		}
+	}
+
+	void FrustumCuller::CullBoxes(const float* aCenterX, const float* aCenterY, const float* aCenterZ, const float* aExtentX, const float* aExtentY, const float* aExtentZ, size_t aCount, std::vector<uint32_t>& aOutVisible) const
+	{
+		aOutVisible.clear();
+
+		constexpr size_t laneCount = SimdFloat::ourLaneCount;
+		const size_t planeCount = myDistance.size();
+		const uint32_t allLanes = (1u << laneCount) - 1;
+
+		size_t first = 0;
+		for (; first + laneCount <= aCount; first += laneCount)
+		{
+			const SimdFloat centerX = SimdLoad(aCenterX + first);
+			const SimdFloat centerY = SimdLoad(aCenterY + first);
+			const SimdFloat centerZ = SimdLoad(aCenterZ + first);
+			const SimdFloat extentX = SimdLoad(aExtentX + first);
+			const SimdFloat extentY = SimdLoad(aExtentY + first);
+			const SimdFloat extentZ = SimdLoad(aExtentZ + first);
+
+			// A box reaches |n.x| * extent.x + |n.y| * extent.y + |n.z| * extent.z towards the plane
+			uint32_t outside = 0;
+			for (size_t plane = 0; plane < planeCount && outside != allLanes; ++plane)
+			{
+				const SimdFloat distance = SimdSet(myNormalX[plane]) * centerX + SimdSet(myNormalY[plane]) * centerY + SimdSet(myNormalZ[plane]) * centerZ - SimdSet(myDistance[plane]);
+				const SimdFloat reach = SimdSet(std::abs(myNormalX[plane])) * extentX + SimdSet(std::abs(myNormalY[plane])) * extentY + SimdSet(std::abs(myNormalZ[plane])) * extentZ;
+				outside |= SimdMoveMask(SimdGreater(distance, reach));
+			}
+
+			uint32_t visible = ~outside & allLanes;
+			for (uint32_t lane = 0; visible != 0; ++lane, visible >>= 1)
+			{
+				if (visible & 1)
+				{
+					aOutVisible.push_back(static_cast<uint32_t>(first) + lane);
+				}
+			}
+		}
+
+		for (; first < aCount; ++first)
+		{
+			bool isOutside = false;
+			for (size_t plane = 0; plane < planeCount && !isOutside; ++plane)
+			{
+				const float distance = myNormalX[plane] * aCenterX[first] + myNormalY[plane] * aCenterY[first] + myNormalZ[plane] * aCenterZ[first] - myDistance[plane];
+				const float reach = std::abs(myNormalX[plane]) * aExtentX[first] + std::abs(myNormalY[plane]) * aExtentY[first] + std::abs(myNormalZ[plane]) * aExtentZ[first];
+				isOutside = distance > reach;
+			}
+			if (!isOutside)
+			{
+				aOutVisible.push_back(static_cast<uint32_t>(first));
+			}
+		}
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "PlaneVolume.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace CU
+{
+	// Culls arrays of bounds against a PlaneVolumef, SimdFloat::ourLaneCount bounds per instruction.
+	// The planes are normalized and transposed into arrays once, every bound is then tested against
+	// every plane with the same conservative rules as PlaneVolume::Classify.
+	class FrustumCuller
+	{
+	public:
+		FrustumCuller() = default;
+		explicit FrustumCuller(const PlaneVolumef& aVolume);
+
+		void Init(const PlaneVolumef& aVolume);
+
+		// Indices of the spheres that are not fully outside, in order. Replaces the content of aOutVisible.
+		void CullSpheres(const float* aCenterX, const float* aCenterY, const float* aCenterZ, const float* aRadius, size_t aCount, std::vector<uint32_t>& aOutVisible) const;
+
+		// Same for boxes given as center and half size
+		void CullBoxes(const float* aCenterX, const float* aCenterY, const float* aCenterZ, const float* aExtentX, const float* aExtentY, const float* aExtentZ, size_t aCount, std::vector<uint32_t>& aOutVisible) const;
+
+	private:
+		// Unit normals pointing out of the volume, a point p is outside a plane when dot(normal, p) > distance
+		std::vector<float> myNormalX;
+		std::vector<float> myNormalY;
+		std::vector<float> myNormalZ;
+		std::vector<float> myDistance;
+	};
+}
+
+namespace CommonUtilities = CU;
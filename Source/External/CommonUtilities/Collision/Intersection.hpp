@@ -5,6 +5,8 @@
 #include "Sphere.hpp"
 #include "AABB3D.hpp"
 
+#include <limits>
+
 namespace CU
 {
 	// If the ray is parallel to the plane, aOutIntersectionPoint remains unchanged. 
@@ -24,133 +26,66 @@ namespace CU
 		return false;
 	}
 	
-	// If the ray intersects the AABB, true is returned, if not, false is returned.
-	// A ray in one of the AABB's sides is counted as intersecting it.
+	// A ray with its inverse direction precomputed, for testing one ray against many boxes.
+	// Zero direction components get the largest T instead of infinity, so the slab test never hits 0 * inf.
 	template<typename T>
-	bool IntersectionAABBRay(const AABB3D<T>& aAABB, const Ray<T>& aRay)
+	struct PrecomputedRay
 	{
+		PrecomputedRay() = default;
+		explicit PrecomputedRay(const Ray<T>& aRay);
 
-		Vector3<T> rayOrg = aRay.GetOrigin();
-		Vector3<T> rayDelta = aRay.GetDirection();
-
-		Vector3<T> min = aAABB.GetMin();
-		Vector3<T> max = aAABB.GetMax();
-
-		bool inside = true;
-
-		T xt, xn;
-		if (rayOrg.x < min.x)
-		{
-			xt = min.x - rayOrg.x;
-			xt /= rayDelta.x;
-			inside = false;
-			xn = T(-1.0f);
-		}
-		else if (rayOrg.x > max.x)
-		{
-			xt = max.x - rayOrg.x;
-			xt /= rayDelta.x;
-			inside = false;
-			xn = T(1.0f);
-		}
-		else
-		{
-			xt = T(-1.0f);
-		}
-
-		T yt, yn;
-		if (rayOrg.y < min.y)
-		{
-			yt = min.y - rayOrg.y;
-			yt /= rayDelta.y;
-			inside = false;
-			yn = T(-1.0f);
-		}
-		else if (rayOrg.y > max.y)
-		{
-			yt = max.y - rayOrg.y;
-			yt /= rayDelta.y;
-			inside = false;
-			yn = T(1.0f);
-		}
-		else
-		{
-			yt = T(-1.0f);
-		}
-
-		T zt, zn;
-		if (rayOrg.z < min.z)
-		{
-			zt = min.z - rayOrg.z;
-			zt /= rayDelta.z;
-			inside = false;
-			zn = T(-1.0f);
-		}
-		else if (rayOrg.z > max.z)
-		{
-			zt = max.z - rayOrg.z;
-			zt /= rayDelta.z;
-			inside = false;
-			zn = T(1.0f);
-		}
-		else
-		{
-			zt = T(-1.0f);
-		}
-
-		// Ray origin inside box?
-		if (inside)
-		{
-			return true;
-		}
-
-		// Select farthest plane - this is
-		// the plane of intersection.
-		int which = 0;
-		T t = xt;
-		if (yt > t)
-		{
-			which = 1;
-			t = yt;
-		}
-		if (zt > t)
-		{
-			which = 2;
-			t = zt;
-		}
-		switch (which)
-		{
-
-			case 0: // intersect with yz plane
-			{
-				T y = rayOrg.y + rayDelta.y * t;
-				if (y < min.y || y > max.y) return false;
-				T z = rayOrg.z + rayDelta.z * t;
-				if (z < min.z || z > max.z) return false;
+		Vector3<T> myOrigin;
+		Vector3<T> myInverseDirection;
+	};
 
-			} break;
-
-			case 1: // intersect with xz plane
-			{
-				T x = rayOrg.x + rayDelta.x * t;
-				if (x < min.x || x > max.x) return false;
-				T z = rayOrg.z + rayDelta.z * t;
-				if (z < min.z || z > max.z) return false;
-
-			} break;
+	template<typename T>
+	inline PrecomputedRay<T>::PrecomputedRay(const Ray<T>& aRay)
+	{
+		const Vector3<T>& direction = aRay.GetDirection();
+		myOrigin = aRay.GetOrigin();
+		myInverseDirection.x = direction.x != T(0) ? T(1) / direction.x : (std::numeric_limits<T>::max)();
+		myInverseDirection.y = direction.y != T(0) ? T(1) / direction.y : (std::numeric_limits<T>::max)();
+		myInverseDirection.z = direction.z != T(0) ? T(1) / direction.z : (std::numeric_limits<T>::max)();
+	}
 
-			case 2: // intersect with xy plane
-			{
-				T x = rayOrg.x + rayDelta.x * t;
-				if (x < min.x || x > max.x) return false;
-				T y = rayOrg.y + rayDelta.y * t;
-				if (y < min.y || y > max.y) return false;
+	// If the ray intersects the AABB, true is returned and the distance along the ray to the first point
+	// inside it is stored in aOutDistance, 0 when the ray starts inside. If not, false is returned.
+	// A ray in one of the AABB's sides is counted as intersecting it, boxes behind the origin are not.
+	template<typename T>
+	bool IntersectionAABBRay(const AABB3D<T>& aAABB, const PrecomputedRay<T>& aRay, T& aOutDistance)
+	{
+		// Slabs: the distances at which the ray enters and leaves each pair of parallel sides, the ray
+		// is inside the box between the last entry and the first exit
+		const Vector3<T>& min = aAABB.GetMin();
+		const Vector3<T>& max = aAABB.GetMax();
+
+		const T x1 = (min.x - aRay.myOrigin.x) * aRay.myInverseDirection.x;
+		const T x2 = (max.x - aRay.myOrigin.x) * aRay.myInverseDirection.x;
+		const T y1 = (min.y - aRay.myOrigin.y) * aRay.myInverseDirection.y;
+		const T y2 = (max.y - aRay.myOrigin.y) * aRay.myInverseDirection.y;
+		const T z1 = (min.z - aRay.myOrigin.z) * aRay.myInverseDirection.z;
+		const T z2 = (max.z - aRay.myOrigin.z) * aRay.myInverseDirection.z;
+
+		const T entry = Max(Max(Min(x1, x2), Min(y1, y2)), Max(Min(z1, z2), T(0)));
+		const T exit = Min(Min(Max(x1, x2), Max(y1, y2)), Max(z1, z2));
+
+		aOutDistance = entry;
+		return entry <= exit;
+	}
 
-			} break;
-		}
+	template<typename T>
+	bool IntersectionAABBRay(const AABB3D<T>& aAABB, const Ray<T>& aRay, T& aOutDistance)
+	{
+		return IntersectionAABBRay(aAABB, PrecomputedRay<T>(aRay), aOutDistance);
+	}
 
-		// Return parametric point of intersection
-		return true;
+	// If the ray intersects the AABB, true is returned, if not, false is returned. A ray starting inside
+	// counts as intersecting, as does a ray in one of the AABB's sides. Boxes behind the origin do not.
+	template<typename T>
+	bool IntersectionAABBRay(const AABB3D<T>& aAABB, const Ray<T>& aRay)
+	{
+		T distance;
+		return IntersectionAABBRay(aAABB, PrecomputedRay<T>(aRay), distance);
 	}
 	
 	// If the ray intersects the sphere, true is returned, if not, false is returned.
@@ -172,6 +107,37 @@ namespace CU
 		return true;
 	}
 
+	// If the AABBs overlap, true is returned, if not, false is returned. Touching AABBs overlap.
+	template<typename T>
+	bool IntersectionAABBAABB(const AABB3D<T>& aFirst, const AABB3D<T>& aSecond)
+	{
+		return aFirst.GetMax().x >= aSecond.GetMin().x && aFirst.GetMin().x <= aSecond.GetMax().x
+			&& aFirst.GetMax().y >= aSecond.GetMin().y && aFirst.GetMin().y <= aSecond.GetMax().y
+			&& aFirst.GetMax().z >= aSecond.GetMin().z && aFirst.GetMin().z <= aSecond.GetMax().z;
+	}
+
+	// If the spheres overlap, true is returned, if not, false is returned. Touching spheres overlap.
+	template<typename T>
+	bool IntersectionSphereSphere(const Sphere<T>& aFirst, const Sphere<T>& aSecond)
+	{
+		const Vector3<T> posDif = aFirst.GetCenter() - aSecond.GetCenter();
+		const T radii = aFirst.GetRadius() + aSecond.GetRadius();
+		return posDif.Dot(posDif) <= radii * radii;
+	}
+
+	// If the sphere overlaps the AABB, true is returned, if not, false is returned.
+	// The closest point in the AABB is compared against the radius, touching counts as overlapping.
+	template<typename T>
+	bool IntersectionSphereAABB(const Sphere<T>& aSphere, const AABB3D<T>& aAABB)
+	{
+		const Vector3<T>& center = aSphere.GetCenter();
+		const Vector3<T>& min = aAABB.GetMin();
+		const Vector3<T>& max = aAABB.GetMax();
+		const Vector3<T> closest(Max(min.x, Min(center.x, max.x)), Max(min.y, Min(center.y, max.y)), Max(min.z, Min(center.z, max.z)));
+		const Vector3<T> posDif = center - closest;
+		return posDif.Dot(posDif) <= aSphere.GetRadius() * aSphere.GetRadius();
+	}
+
 }
 
 namespace CommonUtilities = CU;
\ No newline at end of file
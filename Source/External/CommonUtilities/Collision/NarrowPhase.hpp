@@ -0,0 +1,204 @@
+#pragma once
+#include "Intersection.hpp"
+#include <CommonUtilities/Common/ThreadPool.h>
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <vector>
+
+namespace CU
+{
+	// Indices into the shape arrays passed next to the pair list
+	struct NarrowPhasePair
+	{
+		uint32_t myFirst;
+		uint32_t mySecond;
+	};
+
+	template<class T>
+	struct NarrowPhaseRayHit
+	{
+		uint32_t myRay;
+		uint32_t myShape;
+		T myDistance;
+	};
+
+	// Runs the tests for a broadphase's candidate pairs on a ThreadPool. The pairs are cut into chunks
+	// that the workers and the calling thread take turns claiming. Every chunk writes its results to its
+	// own slice of the output, so no locks are taken, and the slices are packed together afterwards.
+	// Results come out in pair order whatever the thread count.
+	// Tests only read the shapes, so nothing may change them while a Run is going on. Call Run from one
+	// thread at a time and not from a job on the same pool, it waits for the pool's workers.
+	class NarrowPhase
+	{
+	public:
+		explicit NarrowPhase(ThreadPool& aThreadPool, size_t aChunkSize = 2048);
+		NarrowPhase(const NarrowPhase& aNarrowPhase) = delete;
+		NarrowPhase& operator=(const NarrowPhase& aNarrowPhase) = delete;
+		~NarrowPhase() = default;
+
+		// aTest(const Pair&, Result&) returns true and fills in the result for pairs that hit.
+		// Replaces the content of aOutResults with the results of the hits, it can not be aPairs.
+		template<class Pair, class Result, class Test>
+		void Run(const std::vector<Pair>& aPairs, std::vector<Result>& aOutResults, Test&& aTest);
+
+		// Keeps the pairs for which aTest(const Pair&) returns true
+		template<class Pair, class Test>
+		void Filter(const std::vector<Pair>& aPairs, std::vector<Pair>& aOutPairs, Test&& aTest);
+
+		template<class T>
+		void TestAABBs(const std::vector<AABB3D<T>>& aBoxes, const std::vector<NarrowPhasePair>& aPairs, std::vector<NarrowPhasePair>& aOutHits);
+		template<class T>
+		void TestSpheres(const std::vector<Sphere<T>>& aSpheres, const std::vector<NarrowPhasePair>& aPairs, std::vector<NarrowPhasePair>& aOutHits);
+		// myFirst indexes aSpheres, mySecond aBoxes
+		template<class T>
+		void TestSphereAABBs(const std::vector<Sphere<T>>& aSpheres, const std::vector<AABB3D<T>>& aBoxes, const std::vector<NarrowPhasePair>& aPairs, std::vector<NarrowPhasePair>& aOutHits);
+		// myFirst indexes aRays, mySecond the shapes
+		template<class T>
+		void TestRayAABBs(const std::vector<Ray<T>>& aRays, const std::vector<AABB3D<T>>& aBoxes, const std::vector<NarrowPhasePair>& aPairs, std::vector<NarrowPhaseRayHit<T>>& aOutHits);
+		template<class T>
+		void TestRaySpheres(const std::vector<Ray<T>>& aRays, const std::vector<Sphere<T>>& aSpheres, const std::vector<NarrowPhasePair>& aPairs, std::vector<NarrowPhasePair>& aOutHits);
+
+		void SetChunkSize(size_t aChunkSize) { myChunkSize = aChunkSize > 0 ? aChunkSize : 1; }
+		size_t GetChunkSize() const { return myChunkSize; }
+
+	private:
+		ThreadPool& myThreadPool;
+		std::vector<std::future<void>> myJobs;
+		// Hits per chunk, written by whichever thread ran the chunk
+		std::vector<size_t> myChunkHits;
+		size_t myChunkSize;
+	};
+
+	inline NarrowPhase::NarrowPhase(ThreadPool& aThreadPool, size_t aChunkSize)
+		: myThreadPool(aThreadPool)
+		, myChunkSize(aChunkSize > 0 ? aChunkSize : 1)
+	{
+	}
+
+	template<class Pair, class Result, class Test>
+	inline void NarrowPhase::Run(const std::vector<Pair>& aPairs, std::vector<Result>& aOutResults, Test&& aTest)
+	{
+		const size_t pairCount = aPairs.size();
+		const size_t chunkCount = (pairCount + myChunkSize - 1) / myChunkSize;
+
+		// Room for every pair to hit, chunk i writes from i * myChunkSize
+		aOutResults.resize(pairCount);
+		myChunkHits.assign(chunkCount, 0);
+
+		std::atomic<size_t> nextChunk(0);
+		auto runChunks = [&]()
+		{
+			for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+			{
+				const size_t first = chunk * myChunkSize;
+				const size_t last = first + myChunkSize < pairCount ? first + myChunkSize : pairCount;
+				Result* results = aOutResults.data() + first;
+				size_t hits = 0;
+				for (size_t index = first; index < last; ++index)
+				{
+					if (aTest(aPairs[index], results[hits]))
+					{
+						++hits;
+					}
+				}
+				myChunkHits[chunk] = hits;
+			}
+		};
+
+		// The calling thread works too, so only wake as many workers as there are chunks left for
+		const size_t threadCount = myThreadPool.GetThreadCount();
+		const size_t jobCount = chunkCount > 1 ? (chunkCount - 1 < threadCount ? chunkCount - 1 : threadCount) : 0;
+		myJobs.clear();
+		for (size_t job = 0; job < jobCount; ++job)
+		{
+			myJobs.push_back(myThreadPool.Enqueue(runChunks));
+		}
+		runChunks();
+		for (std::future<void>& job : myJobs)
+		{
+			job.wait();
+		}
+		myJobs.clear();
+
+		// Chunk results only ever move towards the front, the first chunk is already in place
+		size_t hitCount = chunkCount > 0 ? myChunkHits[0] : 0;
+		for (size_t chunk = 1; chunk < chunkCount; ++chunk)
+		{
+			const size_t first = chunk * myChunkSize;
+			for (size_t hit = 0; hit < myChunkHits[chunk]; ++hit)
+			{
+				aOutResults[hitCount++] = aOutResults[first + hit];
+			}
+		}
+		aOutResults.resize(hitCount);
+	}
+
+	template<class Pair, class Test>
+	inline void NarrowPhase::Filter(const std::vector<Pair>& aPairs, std::vector<Pair>& aOutPairs, Test&& aTest)
+	{
+		Run(aPairs, aOutPairs, [&aTest](const Pair& aPair, Pair& aOutPair)
+		{
+			if (!aTest(aPair))
+			{
+				return false;
+			}
+			aOutPair = aPair;
+			return true;
+		});
+	}
+
+	template<class T>
+	inline void NarrowPhase::TestAABBs(const std::vector<AABB3D<T>>& aBoxes, const std::vector<NarrowPhasePair>& aPairs, std::vector<NarrowPhasePair>& aOutHits)
+	{
+		Filter(aPairs, aOutHits, [&aBoxes](const NarrowPhasePair& aPair)
+		{
+			return IntersectionAABBAABB(aBoxes[aPair.myFirst], aBoxes[aPair.mySecond]);
+		});
+	}
+
+	template<class T>
+	inline void NarrowPhase::TestSpheres(const std::vector<Sphere<T>>& aSpheres, const std::vector<NarrowPhasePair>& aPairs, std::vector<NarrowPhasePair>& aOutHits)
+	{
+		Filter(aPairs, aOutHits, [&aSpheres](const NarrowPhasePair& aPair)
+		{
+			return IntersectionSphereSphere(aSpheres[aPair.myFirst], aSpheres[aPair.mySecond]);
+		});
+	}
+
+	template<class T>
+	inline void NarrowPhase::TestSphereAABBs(const std::vector<Sphere<T>>& aSpheres, const std::vector<AABB3D<T>>& aBoxes, const std::vector<NarrowPhasePair>& aPairs, std::vector<NarrowPhasePair>& aOutHits)
+	{
+		Filter(aPairs, aOutHits, [&aSpheres, &aBoxes](const NarrowPhasePair& aPair)
+		{
+			return IntersectionSphereAABB(aSpheres[aPair.myFirst], aBoxes[aPair.mySecond]);
+		});
+	}
+
+	template<class T>
+	inline void NarrowPhase::TestRayAABBs(const std::vector<Ray<T>>& aRays, const std::vector<AABB3D<T>>& aBoxes, const std::vector<NarrowPhasePair>& aPairs, std::vector<NarrowPhaseRayHit<T>>& aOutHits)
+	{
+		Run(aPairs, aOutHits, [&aRays, &aBoxes](const NarrowPhasePair& aPair, NarrowPhaseRayHit<T>& aOutHit)
+		{
+			T distance;
+			if (!IntersectionAABBRay(aBoxes[aPair.mySecond], aRays[aPair.myFirst], distance))
+			{
+				return false;
+			}
+			aOutHit = { aPair.myFirst, aPair.mySecond, distance };
+			return true;
+		});
+	}
+
+	template<class T>
+	inline void NarrowPhase::TestRaySpheres(const std::vector<Ray<T>>& aRays, const std::vector<Sphere<T>>& aSpheres, const std::vector<NarrowPhasePair>& aPairs, std::vector<NarrowPhasePair>& aOutHits)
+	{
+		Filter(aPairs, aOutHits, [&aRays, &aSpheres](const NarrowPhasePair& aPair)
+		{
+			return IntersectionSphereRay(aSpheres[aPair.mySecond], aRays[aPair.myFirst]);
+		});
+	}
+}
+
+namespace CommonUtilities = CU;
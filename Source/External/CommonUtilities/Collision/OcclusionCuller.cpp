@@ -0,0 +1,424 @@
+#include "OcclusionCuller.h"
+#include <CommonUtilities/Math/SimdFloat.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace CU
+{
+	namespace
+	{
+		// Clamped before converting, off screen vertices can be far outside the range of an int
+		int ToPixel(float aValue, int aMax)
+		{
+			if (aValue < -1.0f)
+			{
+				return -1;
+			}
+			if (aValue > static_cast<float>(aMax))
+			{
+				return aMax;
+			}
+			return static_cast<int>(std::floor(aValue));
+		}
+	}
+
+	OcclusionCuller::OcclusionCuller(ThreadPool* aThreadPool)
+		: myThreadPool(aThreadPool)
+	{
+		Init();
+	}
+
+	void OcclusionCuller::Init(unsigned int aWidth, unsigned int aHeight)
+	{
+		myTileCountX = aWidth > ourTileSize ? (aWidth + ourTileSize - 1) / ourTileSize : 1;
+		myTileCountY = aHeight > ourTileSize ? (aHeight + ourTileSize - 1) / ourTileSize : 1;
+		myWidth = myTileCountX * ourTileSize;
+		myHeight = myTileCountY * ourTileSize;
+		myTileTriangles.assign(myTileCountX * myTileCountY, std::vector<uint32_t>());
+
+		// Halved down to a single texel, sizes round up so the last row and column keep their pixels
+		myLevels.clear();
+		unsigned int width = myWidth;
+		unsigned int height = myHeight;
+		for (;;)
+		{
+			myLevels.push_back({ std::vector<float>(width * height, FLT_MAX), width, height });
+			if (width == 1 && height == 1)
+			{
+				break;
+			}
+			width = (width + 1) / 2;
+			height = (height + 1) / 2;
+		}
+
+		// Down to one texel per tile
+		myTileLevelCount = 1;
+		for (unsigned int size = ourTileSize; size > 1; size /= 2)
+		{
+			++myTileLevelCount;
+		}
+
+		myTriangles.clear();
+	}
+
+	void OcclusionCuller::BeginFrame(const Matrix4x4f& aViewProjection)
+	{
+		myViewProjection = aViewProjection;
+		myTriangles.clear();
+	}
+
+	void OcclusionCuller::AddOccluder(const Matrix4x4f& aLocalToWorld, const float* aPositions, size_t aPositionCount, const uint32_t* aIndices, size_t aIndexCount)
+	{
+		const Matrix4x4f localToClip = aLocalToWorld * myViewProjection;
+
+		myClipPositions.resize(aPositionCount);
+		for (size_t i = 0; i < aPositionCount; i++)
+		{
+			const float* position = aPositions + i * 3;
+			myClipPositions[i] = Vector4f(position[0], position[1], position[2], 1.0f) * localToClip;
+		}
+
+		for (size_t i = 0; i + 2 < aIndexCount; i += 3)
+		{
+			AddTriangle(myClipPositions[aIndices[i]], myClipPositions[aIndices[i + 1]], myClipPositions[aIndices[i + 2]]);
+		}
+	}
+
+	void OcclusionCuller::AddOccluder(const Matrix4x4f& aLocalToWorld, const std::vector<Vector3f>& aPositions, const std::vector<uint32_t>& aIndices)
+	{
+		static_assert(sizeof(Vector3f) == sizeof(float) * 3, "Positions are read as packed x, y, z triples");
+		AddOccluder(aLocalToWorld, aPositions.empty() ? nullptr : &aPositions[0].x, aPositions.size(), aIndices.data(), aIndices.size());
+	}
+
+	void OcclusionCuller::AddTriangle(const Vector4f& aFirst, const Vector4f& aSecond, const Vector4f& aThird)
+	{
+		// Entirely outside one side of the frustum
+		if ((aFirst.x > aFirst.w && aSecond.x > aSecond.w && aThird.x > aThird.w)
+			|| (aFirst.x < -aFirst.w && aSecond.x < -aSecond.w && aThird.x < -aThird.w)
+			|| (aFirst.y > aFirst.w && aSecond.y > aSecond.w && aThird.y > aThird.w)
+			|| (aFirst.y < -aFirst.w && aSecond.y < -aSecond.w && aThird.y < -aThird.w)
+			|| (aFirst.z < 0.0f && aSecond.z < 0.0f && aThird.z < 0.0f))
+		{
+			return;
+		}
+
+		if (aFirst.z >= 0.0f && aSecond.z >= 0.0f && aThird.z >= 0.0f)
+		{
+			SetupTriangle(aFirst, aSecond, aThird);
+			return;
+		}
+
+		// Cut away the part in front of the near plane, where z < 0. One or two vertices are left
+		// behind it, giving a triangle or a quad.
+		const Vector4f vertices[3] = { aFirst, aSecond, aThird };
+		Vector4f clipped[4];
+		int clippedCount = 0;
+		for (int i = 0; i < 3; i++)
+		{
+			const Vector4f& current = vertices[i];
+			const Vector4f& next = vertices[(i + 1) % 3];
+			if (current.z >= 0.0f)
+			{
+				clipped[clippedCount++] = current;
+			}
+			if ((current.z >= 0.0f) != (next.z >= 0.0f))
+			{
+				const float t = current.z / (current.z - next.z);
+				clipped[clippedCount++] = current + (next - current) * t;
+			}
+		}
+
+		SetupTriangle(clipped[0], clipped[1], clipped[2]);
+		if (clippedCount == 4)
+		{
+			SetupTriangle(clipped[0], clipped[2], clipped[3]);
+		}
+	}
+
+	void OcclusionCuller::SetupTriangle(const Vector4f& aFirst, const Vector4f& aSecond, const Vector4f& aThird)
+	{
+		const Vector4f* vertices[3] = { &aFirst, &aSecond, &aThird };
+		float x[3];
+		float y[3];
+		float depth[3];
+		for (int i = 0; i < 3; i++)
+		{
+			const Vector4f& vertex = *vertices[i];
+			if (vertex.w <= 0.0f)
+			{
+				return;
+			}
+			const float inverseW = 1.0f / vertex.w;
+			x[i] = (vertex.x * inverseW * 0.5f + 0.5f) * static_cast<float>(myWidth);
+			y[i] = (0.5f - vertex.y * inverseW * 0.5f) * static_cast<float>(myHeight);
+			depth[i] = vertex.z * inverseW;
+		}
+
+		// Twice the signed area, also the first edge function at the third vertex
+		const float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+		if (std::fabs(area) < 1e-6f)
+		{
+			return;
+		}
+
+		Triangle triangle;
+
+		// Edge i runs from vertex i to the next one and is zero on it
+		for (int i = 0; i < 3; i++)
+		{
+			const int next = (i + 1) % 3;
+			triangle.myEdgeX[i] = y[i] - y[next];
+			triangle.myEdgeY[i] = x[next] - x[i];
+			triangle.myEdgeConstant[i] = (y[next] - y[i]) * x[i] - (x[next] - x[i]) * y[i];
+		}
+
+		// The edge opposite a vertex divided by the area is that vertex's barycentric weight
+		const float inverseArea = 1.0f / area;
+		triangle.myDepthX = (triangle.myEdgeX[1] * depth[0] + triangle.myEdgeX[2] * depth[1] + triangle.myEdgeX[0] * depth[2]) * inverseArea;
+		triangle.myDepthY = (triangle.myEdgeY[1] * depth[0] + triangle.myEdgeY[2] * depth[1] + triangle.myEdgeY[0] * depth[2]) * inverseArea;
+		triangle.myDepthConstant = (triangle.myEdgeConstant[1] * depth[0] + triangle.myEdgeConstant[2] * depth[1] + triangle.myEdgeConstant[0] * depth[2]) * inverseArea;
+
+		// Both windings are drawn, flip clockwise ones so the inside is positive
+		if (area < 0.0f)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				triangle.myEdgeX[i] = -triangle.myEdgeX[i];
+				triangle.myEdgeY[i] = -triangle.myEdgeY[i];
+				triangle.myEdgeConstant[i] = -triangle.myEdgeConstant[i];
+			}
+		}
+
+		// Pixel p has its center at p + 0.5
+		const float minX = x[0] < x[1] ? (x[0] < x[2] ? x[0] : x[2]) : (x[1] < x[2] ? x[1] : x[2]);
+		const float maxX = x[0] > x[1] ? (x[0] > x[2] ? x[0] : x[2]) : (x[1] > x[2] ? x[1] : x[2]);
+		const float minY = y[0] < y[1] ? (y[0] < y[2] ? y[0] : y[2]) : (y[1] < y[2] ? y[1] : y[2]);
+		const float maxY = y[0] > y[1] ? (y[0] > y[2] ? y[0] : y[2]) : (y[1] > y[2] ? y[1] : y[2]);
+		const int width = static_cast<int>(myWidth);
+		const int height = static_cast<int>(myHeight);
+		triangle.myMinX = ToPixel(minX + 0.5f, width);
+		triangle.myMaxX = ToPixel(maxX - 0.5f, width);
+		triangle.myMinY = ToPixel(minY + 0.5f, height);
+		triangle.myMaxY = ToPixel(maxY - 0.5f, height);
+		triangle.myMinX = triangle.myMinX < 0 ? 0 : triangle.myMinX;
+		triangle.myMinY = triangle.myMinY < 0 ? 0 : triangle.myMinY;
+		triangle.myMaxX = triangle.myMaxX < width - 1 ? triangle.myMaxX : width - 1;
+		triangle.myMaxY = triangle.myMaxY < height - 1 ? triangle.myMaxY : height - 1;
+		if (triangle.myMinX > triangle.myMaxX || triangle.myMinY > triangle.myMaxY)
+		{
+			return;
+		}
+
+		myTriangles.push_back(triangle);
+	}
+
+	void OcclusionCuller::EndFrame()
+	{
+		for (std::vector<uint32_t>& tileTriangles : myTileTriangles)
+		{
+			tileTriangles.clear();
+		}
+		for (uint32_t i = 0; i < myTriangles.size(); i++)
+		{
+			const Triangle& triangle = myTriangles[i];
+			const unsigned int lastTileX = static_cast<unsigned int>(triangle.myMaxX) / ourTileSize;
+			const unsigned int lastTileY = static_cast<unsigned int>(triangle.myMaxY) / ourTileSize;
+			for (unsigned int tileY = static_cast<unsigned int>(triangle.myMinY) / ourTileSize; tileY <= lastTileY; tileY++)
+			{
+				for (unsigned int tileX = static_cast<unsigned int>(triangle.myMinX) / ourTileSize; tileX <= lastTileX; tileX++)
+				{
+					myTileTriangles[tileY * myTileCountX + tileX].push_back(i);
+				}
+			}
+		}
+
+		RunParallel(myTileTriangles.size(), [this](size_t aTile)
+		{
+			RasterizeTile(static_cast<unsigned int>(aTile));
+		});
+
+		// Levels above one texel per tile are small, they are reduced here
+		for (size_t levelIndex = myTileLevelCount; levelIndex < myLevels.size(); levelIndex++)
+		{
+			const Level& source = myLevels[levelIndex - 1];
+			Level& level = myLevels[levelIndex];
+			for (unsigned int y = 0; y < level.myHeight; y++)
+			{
+				const unsigned int sourceY0 = y * 2;
+				const unsigned int sourceY1 = sourceY0 + 1 < source.myHeight ? sourceY0 + 1 : sourceY0;
+				for (unsigned int x = 0; x < level.myWidth; x++)
+				{
+					const unsigned int sourceX0 = x * 2;
+					const unsigned int sourceX1 = sourceX0 + 1 < source.myWidth ? sourceX0 + 1 : sourceX0;
+					const float top = (std::max)(source.myDepth[sourceY0 * source.myWidth + sourceX0], source.myDepth[sourceY0 * source.myWidth + sourceX1]);
+					const float bottom = (std::max)(source.myDepth[sourceY1 * source.myWidth + sourceX0], source.myDepth[sourceY1 * source.myWidth + sourceX1]);
+					level.myDepth[y * level.myWidth + x] = (std::max)(top, bottom);
+				}
+			}
+		}
+	}
+
+	void OcclusionCuller::RasterizeTile(unsigned int aTile)
+	{
+		constexpr unsigned int laneCount = static_cast<unsigned int>(SimdFloat::ourLaneCount);
+		static_assert(ourTileSize % SimdFloat::ourLaneCount == 0, "Tile rows are rasterized in whole registers");
+
+		const int tileX = static_cast<int>((aTile % myTileCountX) * ourTileSize);
+		const int tileY = static_cast<int>((aTile / myTileCountX) * ourTileSize);
+		const int tileLastX = tileX + static_cast<int>(ourTileSize) - 1;
+		const int tileLastY = tileY + static_cast<int>(ourTileSize) - 1;
+
+		Level& pixels = myLevels[0];
+		for (int y = tileY; y <= tileLastY; y++)
+		{
+			float* row = pixels.myDepth.data() + y * pixels.myWidth;
+			for (int x = tileX; x <= tileLastX; x++)
+			{
+				row[x] = FLT_MAX;
+			}
+		}
+
+		float laneOffsets[SimdFloat::ourLaneCount];
+		for (unsigned int lane = 0; lane < laneCount; lane++)
+		{
+			laneOffsets[lane] = static_cast<float>(lane) + 0.5f;
+		}
+		const SimdFloat pixelCenters = SimdLoad(laneOffsets);
+		const SimdFloat zero = SimdSet(0.0f);
+
+		for (uint32_t triangleIndex : myTileTriangles[aTile])
+		{
+			const Triangle& triangle = myTriangles[triangleIndex];
+			const int minX = (triangle.myMinX > tileX ? triangle.myMinX : tileX) / static_cast<int>(laneCount) * static_cast<int>(laneCount);
+			const int maxX = triangle.myMaxX < tileLastX ? triangle.myMaxX : tileLastX;
+			const int minY = triangle.myMinY > tileY ? triangle.myMinY : tileY;
+			const int maxY = triangle.myMaxY < tileLastY ? triangle.myMaxY : tileLastY;
+
+			const SimdFloat edgeX0 = SimdSet(triangle.myEdgeX[0]);
+			const SimdFloat edgeX1 = SimdSet(triangle.myEdgeX[1]);
+			const SimdFloat edgeX2 = SimdSet(triangle.myEdgeX[2]);
+			const SimdFloat depthX = SimdSet(triangle.myDepthX);
+
+			for (int y = minY; y <= maxY; y++)
+			{
+				// The row's part of the edge functions and depth is the same for every lane
+				const float centerY = static_cast<float>(y) + 0.5f;
+				const SimdFloat rowEdge0 = SimdSet(triangle.myEdgeY[0] * centerY + triangle.myEdgeConstant[0]);
+				const SimdFloat rowEdge1 = SimdSet(triangle.myEdgeY[1] * centerY + triangle.myEdgeConstant[1]);
+				const SimdFloat rowEdge2 = SimdSet(triangle.myEdgeY[2] * centerY + triangle.myEdgeConstant[2]);
+				const SimdFloat rowDepth = SimdSet(triangle.myDepthY * centerY + triangle.myDepthConstant);
+
+				float* row = pixels.myDepth.data() + y * pixels.myWidth;
+				for (int x = minX; x <= maxX; x += static_cast<int>(laneCount))
+				{
+					const SimdFloat centerX = SimdSet(static_cast<float>(x)) + pixelCenters;
+					const SimdFloat inside = SimdGreaterEqual(edgeX0 * centerX + rowEdge0, zero)
+						& SimdGreaterEqual(edgeX1 * centerX + rowEdge1, zero)
+						& SimdGreaterEqual(edgeX2 * centerX + rowEdge2, zero);
+					if (SimdMoveMask(inside) == 0)
+					{
+						continue;
+					}
+
+					const SimdFloat depth = depthX * centerX + rowDepth;
+					const SimdFloat current = SimdLoad(row + x);
+					SimdStore(row + x, SimdSelect(inside, SimdMin(depth, current), current));
+				}
+			}
+		}
+
+		// The tile's part of the pyramid, tiles line up with the texels of every level up to one per tile
+		for (unsigned int levelIndex = 1; levelIndex < myTileLevelCount; levelIndex++)
+		{
+			const Level& source = myLevels[levelIndex - 1];
+			Level& level = myLevels[levelIndex];
+			const unsigned int size = ourTileSize >> levelIndex;
+			const unsigned int firstX = static_cast<unsigned int>(tileX) >> levelIndex;
+			const unsigned int firstY = static_cast<unsigned int>(tileY) >> levelIndex;
+			for (unsigned int y = firstY; y < firstY + size; y++)
+			{
+				const float* sourceRow = source.myDepth.data() + y * 2 * source.myWidth;
+				const float* nextSourceRow = sourceRow + source.myWidth;
+				float* row = level.myDepth.data() + y * level.myWidth;
+				for (unsigned int x = firstX; x < firstX + size; x++)
+				{
+					const float top = (std::max)(sourceRow[x * 2], sourceRow[x * 2 + 1]);
+					const float bottom = (std::max)(nextSourceRow[x * 2], nextSourceRow[x * 2 + 1]);
+					row[x] = (std::max)(top, bottom);
+				}
+			}
+		}
+	}
+
+	bool OcclusionCuller::IsVisible(const Matrix4x4f& aLocalToWorld, const Vector3f& aCenter, const Vector3f& aExtents) const
+	{
+		// The corners are the center plus or minus each axis of the box, all moved to clip space
+		const Matrix4x4f localToClip = aLocalToWorld * myViewProjection;
+		const Vector4f center = Vector4f(aCenter.x, aCenter.y, aCenter.z, 1.0f) * localToClip;
+		const Vector4f axisX = Vector4f(aExtents.x, 0.0f, 0.0f, 0.0f) * localToClip;
+		const Vector4f axisY = Vector4f(0.0f, aExtents.y, 0.0f, 0.0f) * localToClip;
+		const Vector4f axisZ = Vector4f(0.0f, 0.0f, aExtents.z, 0.0f) * localToClip;
+
+		float minX = FLT_MAX;
+		float minY = FLT_MAX;
+		float maxX = -FLT_MAX;
+		float maxY = -FLT_MAX;
+		float minDepth = FLT_MAX;
+		for (int corner = 0; corner < 8; corner++)
+		{
+			const Vector4f position = center
+				+ ((corner & 1) ? axisX : axisX * -1.0f)
+				+ ((corner & 2) ? axisY : axisY * -1.0f)
+				+ ((corner & 4) ? axisZ : axisZ * -1.0f);
+			if (position.z < 0.0f || position.w <= 0.0f)
+			{
+				return true;
+			}
+
+			const float inverseW = 1.0f / position.w;
+			const float x = (position.x * inverseW * 0.5f + 0.5f) * static_cast<float>(myWidth);
+			const float y = (0.5f - position.y * inverseW * 0.5f) * static_cast<float>(myHeight);
+			const float depth = position.z * inverseW;
+			minX = x < minX ? x : minX;
+			maxX = x > maxX ? x : maxX;
+			minY = y < minY ? y : minY;
+			maxY = y > maxY ? y : maxY;
+			minDepth = depth < minDepth ? depth : minDepth;
+		}
+
+		if (maxX < 0.0f || maxY < 0.0f || minX >= static_cast<float>(myWidth) || minY >= static_cast<float>(myHeight))
+		{
+			return false;
+		}
+
+		// Every pixel the rectangle touches, not only the ones whose centers it covers
+		const int width = static_cast<int>(myWidth);
+		const int height = static_cast<int>(myHeight);
+		const int firstX = minX > 0.0f ? ToPixel(minX, width) : 0;
+		const int firstY = minY > 0.0f ? ToPixel(minY, height) : 0;
+		const int lastX = (std::min)(ToPixel(maxX, width), width - 1);
+		const int lastY = (std::min)(ToPixel(maxY, height), height - 1);
+
+		// The finest level where the rectangle fits in two by two texels
+		unsigned int levelIndex = 0;
+		while (levelIndex + 1 < myLevels.size() && ((lastX >> levelIndex) - (firstX >> levelIndex) > 1 || (lastY >> levelIndex) - (firstY >> levelIndex) > 1))
+		{
+			levelIndex++;
+		}
+
+		const Level& level = myLevels[levelIndex];
+		for (int y = firstY >> levelIndex; y <= lastY >> levelIndex; y++)
+		{
+			for (int x = firstX >> levelIndex; x <= lastX >> levelIndex; x++)
+			{
+				if (minDepth <= level.myDepth[y * level.myWidth + x])
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include <CommonUtilities/Common/ThreadPool.h>
+#include <CommonUtilities/Math/Matrix4x4.hpp>
+#include <CommonUtilities/Math/Vector3.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <vector>
+
+namespace CU
+{
+	// Software occlusion culling on the CPU, needs no graphics device.
+	// Each frame the designated occluders are rasterized into a small depth buffer, cut into square tiles
+	// that are cleared, rasterized SimdFloat::ourLaneCount pixels at a time and reduced into a hierarchical
+	// depth pyramid by one job per tile. Boxes are then tested against the pyramid: a box is hidden when
+	// its nearest point is behind the farthest occluder depth everywhere its screen rectangle reaches.
+	// Matrices multiply row vectors, depth is clip space z / w with 0 at the near plane, smaller is closer.
+	// Pixels are covered when their center is, so the test is only as exact as the buffer's resolution.
+	class OcclusionCuller
+	{
+	public:
+		static constexpr unsigned int ourTileSize = 32;
+
+		// Without a thread pool all tiles and tests run on the calling thread. Starts at the default size.
+		explicit OcclusionCuller(ThreadPool* aThreadPool = nullptr);
+		OcclusionCuller(const OcclusionCuller& aOcclusionCuller) = delete;
+		OcclusionCuller& operator=(const OcclusionCuller& aOcclusionCuller) = delete;
+		~OcclusionCuller() = default;
+
+		// The size is rounded up to whole tiles, keep it well below the screen's, 256 x 128 is plenty
+		void Init(unsigned int aWidth = 256, unsigned int aHeight = 128);
+
+		// Starts a frame seen through aViewProjection, the view matrix times the projection
+		void BeginFrame(const Matrix4x4f& aViewProjection);
+
+		// Occluders are triangle lists placed by aLocalToWorld, they are drawn from both sides.
+		// Triangles crossing the near plane are clipped, so walls the camera stands next to still occlude.
+		// aPositions holds aPositionCount packed x, y, z triples.
+		void AddOccluder(const Matrix4x4f& aLocalToWorld, const float* aPositions, size_t aPositionCount, const uint32_t* aIndices, size_t aIndexCount);
+		void AddOccluder(const Matrix4x4f& aLocalToWorld, const std::vector<Vector3f>& aPositions, const std::vector<uint32_t>& aIndices);
+
+		// Rasterizes this frame's occluders and builds the depth pyramid, call before testing
+		void EndFrame();
+
+		// False when the box given as center and half size, placed by aLocalToWorld, is hidden behind the
+		// occluders or off screen. Boxes reaching in front of the near plane are always visible.
+		// Safe from several threads.
+		bool IsVisible(const Matrix4x4f& aLocalToWorld, const Vector3f& aCenter, const Vector3f& aExtents) const;
+
+		// Indices below aCount for which aIsVisible(index) is true, in order. Replaces the content of
+		// aOutVisible. The indices are tested in chunks on the thread pool.
+		template<class IsVisibleAt>
+		void Cull(size_t aCount, IsVisibleAt&& aIsVisible, std::vector<uint32_t>& aOutVisible);
+
+		unsigned int GetWidth() const { return myWidth; }
+		unsigned int GetHeight() const { return myHeight; }
+		// Nearest occluder depth per pixel, rows top to bottom, FLT_MAX where nothing was drawn
+		const std::vector<float>& GetDepthBuffer() const { return myLevels[0].myDepth; }
+		size_t GetOccluderTriangleCount() const { return myTriangles.size(); }
+
+	private:
+		// A screen space triangle ready for rasterizing. The edge functions are positive inside and the
+		// depth is a plane, both evaluated at pixel coordinates.
+		struct Triangle
+		{
+			float myEdgeX[3];
+			float myEdgeY[3];
+			float myEdgeConstant[3];
+			float myDepthX;
+			float myDepthY;
+			float myDepthConstant;
+			// Pixels whose centers can be inside, inclusive
+			int myMinX;
+			int myMinY;
+			int myMaxX;
+			int myMaxY;
+		};
+
+		// One level of the pyramid, each texel holds the farthest depth of the pixels below it
+		struct Level
+		{
+			std::vector<float> myDepth;
+			unsigned int myWidth;
+			unsigned int myHeight;
+		};
+
+		static constexpr size_t ourChunkSize = 256;
+
+		// Takes clip space vertices and clips them against the near plane
+		void AddTriangle(const Vector4f& aFirst, const Vector4f& aSecond, const Vector4f& aThird);
+		void SetupTriangle(const Vector4f& aFirst, const Vector4f& aSecond, const Vector4f& aThird);
+		void RasterizeTile(unsigned int aTile);
+
+		// Runs aJob(index) for every index below aCount on the pool and the calling thread
+		template<class Job>
+		void RunParallel(size_t aCount, Job&& aJob);
+
+		ThreadPool* myThreadPool;
+		std::vector<std::future<void>> myJobs;
+
+		Matrix4x4f myViewProjection;
+		std::vector<Triangle> myTriangles;
+		// The occluder being added, moved to clip space
+		std::vector<Vector4f> myClipPositions;
+		// Triangles overlapping each tile, filled by EndFrame
+		std::vector<std::vector<uint32_t>> myTileTriangles;
+		std::vector<Level> myLevels;
+		// Per index results of Cull, written by whichever thread tested the index
+		std::vector<uint8_t> myIsVisible;
+
+		unsigned int myWidth = 0;
+		unsigned int myHeight = 0;
+		unsigned int myTileCountX = 0;
+		unsigned int myTileCountY = 0;
+		// Levels a tile job builds, the rest are reduced from them by EndFrame
+		unsigned int myTileLevelCount = 0;
+	};
+
+	template<class IsVisibleAt>
+	void OcclusionCuller::Cull(size_t aCount, IsVisibleAt&& aIsVisible, std::vector<uint32_t>& aOutVisible)
+	{
+		myIsVisible.resize(aCount);
+
+		RunParallel((aCount + ourChunkSize - 1) / ourChunkSize, [&](size_t aChunk)
+		{
+			const size_t first = aChunk * ourChunkSize;
+			const size_t last = first + ourChunkSize < aCount ? first + ourChunkSize : aCount;
+			for (size_t i = first; i < last; i++)
+			{
+				myIsVisible[i] = aIsVisible(i) ? 1 : 0;
+			}
+		});
+
+		aOutVisible.clear();
+		for (size_t i = 0; i < aCount; i++)
+		{
+			if (myIsVisible[i])
+			{
+				aOutVisible.push_back(static_cast<uint32_t>(i));
+			}
+		}
+	}
+
+	template<class Job>
+	void OcclusionCuller::RunParallel(size_t aCount, Job&& aJob)
+	{
+		std::atomic<size_t> nextIndex(0);
+		auto runJobs = [&]()
+		{
+			for (size_t index = nextIndex++; index < aCount; index = nextIndex++)
+			{
+				aJob(index);
+			}
+		};
+
+		// The calling thread works too, so only wake as many workers as there are jobs left for
+		const size_t threadCount = myThreadPool ? myThreadPool->GetThreadCount() : 0;
+		const size_t workerCount = aCount > 1 ? (aCount - 1 < threadCount ? aCount - 1 : threadCount) : 0;
+		myJobs.clear();
+		for (size_t worker = 0; worker < workerCount; worker++)
+		{
+			myJobs.push_back(myThreadPool->Enqueue(runJobs));
+		}
+		runJobs();
+		for (std::future<void>& job : myJobs)
+		{
+			job.wait();
+		}
+		myJobs.clear();
+	}
+}
+
+namespace CommonUtilities = CU;
@@ -1,9 +1,19 @@
 #pragma once
+#include "AABB3D.hpp"
 #include "Plane.hpp"
+#include "Sphere.hpp"
+#include <CommonUtilities/Math/Matrix4x4.hpp>
 #include <vector>
 
 namespace CU
 {
+	enum class VolumeSide
+	{
+		Outside,
+		Intersecting,
+		Inside,
+	};
+
 	template<class T>
 	class PlaneVolume
 	{
@@ -16,6 +26,10 @@ namespace CU
 		
 		~PlaneVolume() = default;
 
+		// The six frustum planes of a view-projection matrix, for row vectors (v * M) and a clip space
+		// depth from 0 to w like Direct3D. The normals are unit length and point out of the frustum.
+		static PlaneVolume<T> CreateFromViewProjection(const Matrix4x4<T>& aViewProjection);
+
 		// Add a Plane to the PlaneVolume.
 		void AddPlane(const Plane<T>& aPlane);
 
@@ -23,6 +37,13 @@ namespace CU
 		// plane or on the side the normal is pointing away from for all the planes in the PlaneVolume.
 		bool IsInside(const Vector3<T>& aPosition) const;
 
+		// Outside when the shape is fully outside any plane, Inside when it is inside all of them.
+		// Shapes near a corner of the volume can be reported as Intersecting although they are outside.
+		VolumeSide Classify(const Sphere<T>& aSphere) const;
+		VolumeSide Classify(const AABB3D<T>& aAABB) const;
+
+		const std::vector<Plane<T>>& GetPlanes() const { return myPlaneList; }
+
 	private:
 
 		std::vector<Plane<T>> myPlaneList;
@@ -42,6 +63,30 @@ namespace CU
 		myPlaneList = aPlaneList;
 	}
 
+	template<class T>
+	inline PlaneVolume<T> PlaneVolume<T>::CreateFromViewProjection(const Matrix4x4<T>& aViewProjection)
+	{
+		// Gribb and Hartmann: a point is inside when its clip coordinates satisfy -w <= x <= w, -w <= y <= w
+		// and 0 <= z <= w, every inequality is a plane made from the matrix's columns
+		const Vector4<T> x = aViewProjection.GetColumn(1);
+		const Vector4<T> y = aViewProjection.GetColumn(2);
+		const Vector4<T> z = aViewProjection.GetColumn(3);
+		const Vector4<T> w = aViewProjection.GetColumn(4);
+		const Vector4<T> insideEquations[6] = { w + x, w - x, w + y, w - y, z, w - z };
+
+		PlaneVolume<T> volume;
+		for (const Vector4<T>& equation : insideEquations)
+		{
+			// Inside means a*x + b*y + c*z + d >= 0, Plane wants the normal pointing the other way
+			const Vector3<T> inwardNormal(equation.x, equation.y, equation.z);
+			const T length = inwardNormal.Length();
+			const Vector3<T> normal = inwardNormal * (T(-1) / length);
+			const Vector3<T> point = inwardNormal * (-equation.w / (length * length));
+			volume.AddPlane(Plane<T>(point, normal));
+		}
+		return volume;
+	}
+
 	template<class T>
 	inline void PlaneVolume<T>::AddPlane(const Plane<T>& aPlane)
 	{
@@ -51,7 +96,7 @@ namespace CU
 	template<class T>
 	inline bool PlaneVolume<T>::IsInside(const Vector3<T>& aPosition) const
 	{
-		for each (Plane<T> plane in myPlaneList)
+		for (const Plane<T>& plane : myPlaneList)
 		{
 			if (plane.IsInside(aPosition) == false)
 			{
@@ -60,6 +105,54 @@ namespace CU
 		}
 		return true;
 	}
+
+	template<class T>
+	inline VolumeSide PlaneVolume<T>::Classify(const Sphere<T>& aSphere) const
+	{
+		// Compared squared so the normals do not have to be unit length
+		const T radius = aSphere.GetRadius();
+		VolumeSide side = VolumeSide::Inside;
+		for (const Plane<T>& plane : myPlaneList)
+		{
+			const Vector3<T>& normal = plane.GetNormal();
+			const T distance = (aSphere.GetCenter() - plane.GetPointOnPlane()).Dot(normal);
+			const T reach = radius * radius * normal.Dot(normal);
+			if (distance > T(0) && distance * distance > reach)
+			{
+				return VolumeSide::Outside;
+			}
+			if (distance > T(0) || distance * distance < reach)
+			{
+				side = VolumeSide::Intersecting;
+			}
+		}
+		return side;
+	}
+
+	template<class T>
+	inline VolumeSide PlaneVolume<T>::Classify(const AABB3D<T>& aAABB) const
+	{
+		// Per plane only two corners matter: the one furthest against the normal decides if the box is
+		// outside, the one furthest along it if the box is fully inside
+		const Vector3<T>& min = aAABB.GetMin();
+		const Vector3<T>& max = aAABB.GetMax();
+		VolumeSide side = VolumeSide::Inside;
+		for (const Plane<T>& plane : myPlaneList)
+		{
+			const Vector3<T>& normal = plane.GetNormal();
+			const Vector3<T> mostInside(normal.x >= T(0) ? min.x : max.x, normal.y >= T(0) ? min.y : max.y, normal.z >= T(0) ? min.z : max.z);
+			const Vector3<T> mostOutside(normal.x >= T(0) ? max.x : min.x, normal.y >= T(0) ? max.y : min.y, normal.z >= T(0) ? max.z : min.z);
+			if (!plane.IsInside(mostInside))
+			{
+				return VolumeSide::Outside;
+			}
+			if (!plane.IsInside(mostOutside))
+			{
+				side = VolumeSide::Intersecting;
+			}
+		}
+		return side;
+	}
 }
 
 namespace CommonUtilities = CU;
\ No newline at end of file
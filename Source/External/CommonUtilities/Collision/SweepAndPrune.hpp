@@ -0,0 +1,413 @@
+#pragma once
+#include "AABB3D.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+namespace CU
+{
+	// Sweep and prune broadphase. Every axis keeps a sorted array of box endpoints and a moved box is
+	// insertion sorted back into place right away, so when boxes move a little each frame a move costs
+	// about as much as the number of endpoints it passes. Overlapping pairs are tracked from the swaps:
+	// a box's min passing another box's max may start an overlap, a max passing a min ends one.
+	// Boxes are inclusive, touching boxes overlap.
+	template<class T, int Dimensions, class Data = void*>
+	class SweepAndPrune
+	{
+		static_assert(Dimensions >= 1 && Dimensions <= 3, "SweepAndPrune supports one to three dimensions");
+
+	public:
+		struct Pair
+		{
+			Data myFirst;
+			Data mySecond;
+		};
+
+		SweepAndPrune() = default;
+		~SweepAndPrune() = default;
+
+		// Returns the proxy ID used for every other call
+		int Add(const T (&aMin)[Dimensions], const T (&aMax)[Dimensions], const Data& aData);
+		int Add(const AABB3D<T>& aBox, const Data& aData);
+		void Remove(int aProxy);
+
+		void Move(int aProxy, const T (&aMin)[Dimensions], const T (&aMax)[Dimensions]);
+		void Move(int aProxy, const AABB3D<T>& aBox);
+
+		const Data& GetData(int aProxy) const;
+
+		// aCallback(const Data&, const Data&) for every overlapping pair, each pair once
+		template<class Callback>
+		void ForEachPair(Callback&& aCallback) const;
+
+		// aCallback(const Data&) for every box overlapping the given one, return false to stop
+		template<class Callback>
+		void QueryOverlap(const T (&aMin)[Dimensions], const T (&aMax)[Dimensions], Callback&& aCallback) const;
+
+		// Pair changes are only recorded while tracking is on, off by default so a broadphase that is
+		// only queried never collects them. Turning it off drops the pending changes.
+		void SetTrackPairChanges(bool aTrackPairChanges);
+		bool GetTrackPairChanges() const { return myIsTrackingPairChanges; }
+
+		// Pairs that started and stopped overlapping since the last call, or since tracking was turned on.
+		// A pair that started and stopped in between is in neither. Replaces the content of both vectors.
+		void TakePairChanges(std::vector<Pair>& aOutAdded, std::vector<Pair>& aOutRemoved);
+
+		size_t GetPairCount() const { return myPairs.size(); }
+		size_t size() const { return myProxies.size() - myFreeProxies.size() - myRemovedProxies.size(); }
+
+	private:
+		struct Endpoint
+		{
+			T myValue;
+			uint32_t myProxyAndIsMax;
+
+			uint32_t GetProxy() const { return myProxyAndIsMax >> 1; }
+			bool IsMax() const { return (myProxyAndIsMax & 1) != 0; }
+		};
+
+		struct Proxy
+		{
+			T myMin[Dimensions];
+			T myMax[Dimensions];
+			uint32_t myEndpoints[Dimensions][2];
+			Data myData = Data();
+			bool myIsActive = false;
+		};
+
+		struct PairChange
+		{
+			uint64_t myKey;
+			Data myFirst;
+			Data mySecond;
+			int myDelta;
+		};
+
+		void SiftLeft(int aAxis, uint32_t aIndex);
+		void SiftRight(int aAxis, uint32_t aIndex, bool aToEnd);
+		void Swap(int aAxis, uint32_t aLeftIndex);
+		void OnSwap(const Endpoint& aMovedLeft, const Endpoint& aMovedRight);
+		bool Overlaps(uint32_t aFirst, uint32_t aSecond) const;
+
+		static bool IsLess(const Endpoint& aFirst, const Endpoint& aSecond);
+		static uint64_t GetPairKey(uint32_t aFirst, uint32_t aSecond);
+
+		std::vector<Endpoint> myAxes[Dimensions];
+		std::vector<Proxy> myProxies;
+		std::vector<uint32_t> myFreeProxies;
+		// Removed while changes were pending, not reused until those are taken since their IDs are in them
+		std::vector<uint32_t> myRemovedProxies;
+		std::unordered_set<uint64_t> myPairs;
+		std::vector<PairChange> myPairChanges;
+		bool myIsTrackingPairChanges = false;
+	};
+
+	using SweepAndPrune2Df = SweepAndPrune<float, 2>;
+	using SweepAndPrune3Df = SweepAndPrune<float, 3>;
+
+	template<class T, int Dimensions, class Data>
+	inline int SweepAndPrune<T, Dimensions, Data>::Add(const T (&aMin)[Dimensions], const T (&aMax)[Dimensions], const Data& aData)
+	{
+		uint32_t proxyIndex;
+		if (!myFreeProxies.empty())
+		{
+			proxyIndex = myFreeProxies.back();
+			myFreeProxies.pop_back();
+		}
+		else
+		{
+			proxyIndex = static_cast<uint32_t>(myProxies.size());
+			myProxies.emplace_back();
+		}
+
+		Proxy& proxy = myProxies[proxyIndex];
+		proxy.myData = aData;
+		proxy.myIsActive = true;
+		for (int axis = 0; axis < Dimensions; ++axis)
+		{
+			proxy.myMin[axis] = aMin[axis];
+			proxy.myMax[axis] = aMax[axis];
+		}
+
+		// Appended at the end and sorted into place, passing the other boxes' endpoints finds the new pairs
+		for (int axis = 0; axis < Dimensions; ++axis)
+		{
+			std::vector<Endpoint>& endpoints = myAxes[axis];
+			const uint32_t minIndex = static_cast<uint32_t>(endpoints.size());
+			endpoints.push_back({ aMin[axis], proxyIndex << 1 });
+			endpoints.push_back({ aMax[axis], (proxyIndex << 1) | 1 });
+			myProxies[proxyIndex].myEndpoints[axis][0] = minIndex;
+			myProxies[proxyIndex].myEndpoints[axis][1] = minIndex + 1;
+
+			SiftLeft(axis, minIndex);
+			SiftLeft(axis, myProxies[proxyIndex].myEndpoints[axis][1]);
+		}
+		return static_cast<int>(proxyIndex);
+	}
+
+	template<class T, int Dimensions, class Data>
+	inline int SweepAndPrune<T, Dimensions, Data>::Add(const AABB3D<T>& aBox, const Data& aData)
+	{
+		static_assert(Dimensions == 3, "AABB3D needs a three dimensional SweepAndPrune");
+		const T min[Dimensions] = { aBox.GetMin().x, aBox.GetMin().y, aBox.GetMin().z };
+		const T max[Dimensions] = { aBox.GetMax().x, aBox.GetMax().y, aBox.GetMax().z };
+		return Add(min, max, aData);
+	}
+
+	template<class T, int Dimensions, class Data>
+	inline void SweepAndPrune<T, Dimensions, Data>::Remove(int aProxy)
+	{
+		assert(aProxy >= 0 && aProxy < static_cast<int>(myProxies.size()) && myProxies[aProxy].myIsActive);
+
+		// Inactive proxies never start overlaps, moving the endpoints past everything ends all of its pairs
+		const uint32_t proxyIndex = static_cast<uint32_t>(aProxy);
+		myProxies[proxyIndex].myIsActive = false;
+		for (int axis = 0; axis < Dimensions; ++axis)
+		{
+			SiftRight(axis, myProxies[proxyIndex].myEndpoints[axis][1], true);
+			SiftRight(axis, myProxies[proxyIndex].myEndpoints[axis][0], true);
+			myAxes[axis].resize(myAxes[axis].size() - 2);
+		}
+
+		if (myPairChanges.empty())
+		{
+			myFreeProxies.push_back(proxyIndex);
+		}
+		else
+		{
+			myRemovedProxies.push_back(proxyIndex);
+		}
+	}
+
+	template<class T, int Dimensions, class Data>
+	inline void SweepAndPrune<T, Dimensions, Data>::Move(int aProxy, const T (&aMin)[Dimensions], const T (&aMax)[Dimensions])
+	{
+		assert(aProxy >= 0 && aProxy < static_cast<int>(myProxies.size()) && myProxies[aProxy].myIsActive);
+
+		const uint32_t proxyIndex = static_cast<uint32_t>(aProxy);
+		Proxy& proxy = myProxies[proxyIndex];
+		for (int axis = 0; axis < Dimensions; ++axis)
+		{
+			proxy.myMin[axis] = aMin[axis];
+			proxy.myMax[axis] = aMax[axis];
+		}
+
+		for (int axis = 0; axis < Dimensions; ++axis)
+		{
+			std::vector<Endpoint>& endpoints = myAxes[axis];
+			const uint32_t minIndex = proxy.myEndpoints[axis][0];
+			const uint32_t maxIndex = proxy.myEndpoints[axis][1];
+			endpoints[minIndex].myValue = aMin[axis];
+			endpoints[maxIndex].myValue = aMax[axis];
+
+			// Only true inversions are swapped, so the order the endpoints are sifted in does not matter
+			SiftLeft(axis, proxy.myEndpoints[axis][0]);
+			SiftLeft(axis, proxy.myEndpoints[axis][1]);
+			SiftRight(axis, proxy.myEndpoints[axis][1], false);
+			SiftRight(axis, proxy.myEndpoints[axis][0], false);
+		}
+	}
+
+	template<class T, int Dimensions, class Data>
+	inline void SweepAndPrune<T, Dimensions, Data>::Move(int aProxy, const AABB3D<T>& aBox)
+	{
+		static_assert(Dimensions == 3, "AABB3D needs a three dimensional SweepAndPrune");
+		const T min[Dimensions] = { aBox.GetMin().x, aBox.GetMin().y, aBox.GetMin().z };
+		const T max[Dimensions] = { aBox.GetMax().x, aBox.GetMax().y, aBox.GetMax().z };
+		Move(aProxy, min, max);
+	}
+
+	template<class T, int Dimensions, class Data>
+	inline const Data& SweepAndPrune<T, Dimensions, Data>::GetData(int aProxy) const
+	{
+		return myProxies[aProxy].myData;
+	}
+
+	template<class T, int Dimensions, class Data>
+	template<class Callback>
+	inline void SweepAndPrune<T, Dimensions, Data>::ForEachPair(Callback&& aCallback) const
+	{
+		for (uint64_t key : myPairs)
+		{
+			aCallback(myProxies[static_cast<uint32_t>(key >> 32)].myData, myProxies[static_cast<uint32_t>(key)].myData);
+		}
+	}
+
+	template<class T, int Dimensions, class Data>
+	template<class Callback>
+	inline void SweepAndPrune<T, Dimensions, Data>::QueryOverlap(const T (&aMin)[Dimensions], const T (&aMax)[Dimensions], Callback&& aCallback) const
+	{
+		// Every box starting at or before the query's max on the first axis is a candidate
+		for (const Endpoint& endpoint : myAxes[0])
+		{
+			if (endpoint.myValue > aMax[0])
+			{
+				break;
+			}
+			if (endpoint.IsMax())
+			{
+				continue;
+			}
+
+			const Proxy& proxy = myProxies[endpoint.GetProxy()];
+			bool isOverlapping = true;
+			for (int axis = 0; axis < Dimensions && isOverlapping; ++axis)
+			{
+				isOverlapping = proxy.myMin[axis] <= aMax[axis] && proxy.myMax[axis] >= aMin[axis];
+			}
+
+			if (isOverlapping && !aCallback(proxy.myData))
+			{
+				return;
+			}
+		}
+	}
+
+	template<class T, int Dimensions, class Data>
+	inline void SweepAndPrune<T, Dimensions, Data>::SetTrackPairChanges(bool aTrackPairChanges)
+	{
+		myIsTrackingPairChanges = aTrackPairChanges;
+		if (!aTrackPairChanges)
+		{
+			myPairChanges.clear();
+			myFreeProxies.insert(myFreeProxies.end(), myRemovedProxies.begin(), myRemovedProxies.end());
+			myRemovedProxies.clear();
+		}
+	}
+
+	template<class T, int Dimensions, class Data>
+	inline void SweepAndPrune<T, Dimensions, Data>::TakePairChanges(std::vector<Pair>& aOutAdded, std::vector<Pair>& aOutRemoved)
+	{
+		aOutAdded.clear();
+		aOutRemoved.clear();
+
+		// A pair can change several times between calls, only the sum of its changes is reported
+		std::stable_sort(myPairChanges.begin(), myPairChanges.end(), [](const PairChange& aFirst, const PairChange& aSecond)
+		{
+			return aFirst.myKey < aSecond.myKey;
+		});
+
+		for (size_t first = 0; first < myPairChanges.size();)
+		{
+			int delta = 0;
+			size_t last = first;
+			for (; last < myPairChanges.size() && myPairChanges[last].myKey == myPairChanges[first].myKey; ++last)
+			{
+				delta += myPairChanges[last].myDelta;
+			}
+
+			const PairChange& change = myPairChanges[first];
+			if (delta > 0)
+			{
+				aOutAdded.push_back({ change.myFirst, change.mySecond });
+			}
+			else if (delta < 0)
+			{
+				aOutRemoved.push_back({ change.myFirst, change.mySecond });
+			}
+			first = last;
+		}
+		myPairChanges.clear();
+
+		myFreeProxies.insert(myFreeProxies.end(), myRemovedProxies.begin(), myRemovedProxies.end());
+		myRemovedProxies.clear();
+	}
+
+	template<class T, int Dimensions, class Data>
+	inline void SweepAndPrune<T, Dimensions, Data>::SiftLeft(int aAxis, uint32_t aIndex)
+	{
+		std::vector<Endpoint>& endpoints = myAxes[aAxis];
+		uint32_t index = aIndex;
+		while (index > 0 && IsLess(endpoints[index], endpoints[index - 1]))
+		{
+			Swap(aAxis, index - 1);
+			--index;
+		}
+	}
+
+	template<class T, int Dimensions, class Data>
+	inline void SweepAndPrune<T, Dimensions, Data>::SiftRight(int aAxis, uint32_t aIndex, bool aToEnd)
+	{
+		std::vector<Endpoint>& endpoints = myAxes[aAxis];
+		uint32_t index = aIndex;
+		while (index + 1 < endpoints.size() && (aToEnd || IsLess(endpoints[index + 1], endpoints[index])))
+		{
+			Swap(aAxis, index);
+			++index;
+		}
+	}
+
+	template<class T, int Dimensions, class Data>
+	inline void SweepAndPrune<T, Dimensions, Data>::Swap(int aAxis, uint32_t aLeftIndex)
+	{
+		std::vector<Endpoint>& endpoints = myAxes[aAxis];
+		Endpoint& left = endpoints[aLeftIndex];
+		Endpoint& right = endpoints[aLeftIndex + 1];
+		OnSwap(right, left);
+
+		std::swap(left, right);
+		myProxies[left.GetProxy()].myEndpoints[aAxis][left.IsMax()] = aLeftIndex;
+		myProxies[right.GetProxy()].myEndpoints[aAxis][right.IsMax()] = aLeftIndex + 1;
+	}
+
+	template<class T, int Dimensions, class Data>
+	inline void SweepAndPrune<T, Dimensions, Data>::OnSwap(const Endpoint& aMovedLeft, const Endpoint& aMovedRight)
+	{
+		const uint32_t first = aMovedLeft.GetProxy();
+		const uint32_t second = aMovedRight.GetProxy();
+		if (first == second || aMovedLeft.IsMax() == aMovedRight.IsMax())
+		{
+			return;
+		}
+
+		const uint64_t key = GetPairKey(first, second);
+		const Proxy& lowProxy = myProxies[static_cast<uint32_t>(key >> 32)];
+		const Proxy& highProxy = myProxies[static_cast<uint32_t>(key)];
+
+		if (!aMovedLeft.IsMax())
+		{
+			// A min passed a max, the boxes now overlap on this axis
+			if (myProxies[first].myIsActive && myProxies[second].myIsActive && Overlaps(first, second) && myPairs.insert(key).second && myIsTrackingPairChanges)
+			{
+				myPairChanges.push_back({ key, lowProxy.myData, highProxy.myData, 1 });
+			}
+		}
+		else if (myPairs.erase(key) > 0 && myIsTrackingPairChanges)
+		{
+			myPairChanges.push_back({ key, lowProxy.myData, highProxy.myData, -1 });
+		}
+	}
+
+	template<class T, int Dimensions, class Data>
+	inline bool SweepAndPrune<T, Dimensions, Data>::Overlaps(uint32_t aFirst, uint32_t aSecond) const
+	{
+		const Proxy& first = myProxies[aFirst];
+		const Proxy& second = myProxies[aSecond];
+		for (int axis = 0; axis < Dimensions; ++axis)
+		{
+			if (first.myMax[axis] < second.myMin[axis] || first.myMin[axis] > second.myMax[axis])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<class T, int Dimensions, class Data>
+	inline bool SweepAndPrune<T, Dimensions, Data>::IsLess(const Endpoint& aFirst, const Endpoint& aSecond)
+	{
+		// On equal values mins go first, that keeps touching boxes overlapping
+		return aFirst.myValue < aSecond.myValue || (aFirst.myValue == aSecond.myValue && !aFirst.IsMax() && aSecond.IsMax());
+	}
+
+	template<class T, int Dimensions, class Data>
+	inline uint64_t SweepAndPrune<T, Dimensions, Data>::GetPairKey(uint32_t aFirst, uint32_t aSecond)
+	{
+		return aFirst < aSecond ? (static_cast<uint64_t>(aFirst) << 32) | aSecond : (static_cast<uint64_t>(aSecond) << 32) | aFirst;
+	}
+}
+
+namespace CommonUtilities = CU;
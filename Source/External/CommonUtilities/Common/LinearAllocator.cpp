@@ -0,0 +1,90 @@
+#include "LinearAllocator.h"
+
+CU::LinearAllocator::LinearAllocator(size_t aBlockSize)
+{
+	myBlockSize = aBlockSize;
+	myCurrentBlock = 0;
+	myOffset = 0;
+	myUsedBytes = 0;
+	myHighWaterMark = 0;
+}
+
+void* CU::LinearAllocator::Allocate(size_t aSize, size_t aAlignment)
+{
+	while (true)
+	{
+		if (myCurrentBlock < myBlocks.size())
+		{
+			Block& block = myBlocks[myCurrentBlock];
+			const uintptr_t base = reinterpret_cast<uintptr_t>(block.myMemory.get());
+			const uintptr_t aligned = (base + myOffset + aAlignment - 1) & ~(static_cast<uintptr_t>(aAlignment) - 1);
+			const size_t newOffset = static_cast<size_t>(aligned - base) + aSize;
+
+			if (newOffset <= block.mySize)
+			{
+				myUsedBytes += newOffset - myOffset;
+				myOffset = newOffset;
+				if (myUsedBytes > myHighWaterMark)
+				{
+					myHighWaterMark = myUsedBytes;
+				}
+				return reinterpret_cast<void*>(aligned);
+			}
+
+			// Whatever is left in this block is wasted, count it so the high water mark reflects real usage
+			myUsedBytes += block.mySize - myOffset;
+			++myCurrentBlock;
+			myOffset = 0;
+		}
+
+		if (myCurrentBlock >= myBlocks.size())
+		{
+			AddBlock(aSize + aAlignment);
+		}
+	}
+}
+
+void CU::LinearAllocator::Reset()
+{
+	if (myBlocks.size() > 1)
+	{
+		const size_t capacity = GetCapacity();
+		myBlocks.clear();
+		AddBlock(capacity);
+	}
+
+	myCurrentBlock = 0;
+	myOffset = 0;
+	myUsedBytes = 0;
+}
+
+size_t CU::LinearAllocator::GetUsedBytes() const
+{
+	return myUsedBytes;
+}
+
+size_t CU::LinearAllocator::GetHighWaterMark() const
+{
+	return myHighWaterMark;
+}
+
+size_t CU::LinearAllocator::GetCapacity() const
+{
+	size_t capacity = 0;
+	for (const Block& block : myBlocks)
+	{
+		capacity += block.mySize;
+	}
+	return capacity;
+}
+
+size_t CU::LinearAllocator::GetBlockCount() const
+{
+	return myBlocks.size();
+}
+
+void CU::LinearAllocator::AddBlock(size_t aMinimumSize)
+{
+	const size_t size = aMinimumSize > myBlockSize ? aMinimumSize : myBlockSize;
+	myBlocks.push_back({ std::make_unique<uint8_t[]>(size), size });
+}
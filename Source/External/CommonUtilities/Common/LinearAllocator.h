@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace CU
+{
+	// Bump allocator: allocations are a pointer increment and everything is released at once by Reset.
+	// Destructors are never run, only place trivially destructible data here or destroy it yourself first.
+	class LinearAllocator
+	{
+	public:
+		explicit LinearAllocator(size_t aBlockSize = 64 * 1024);
+		LinearAllocator(const LinearAllocator& aLinearAllocator) = delete;
+		LinearAllocator& operator=(const LinearAllocator& aLinearAllocator) = delete;
+		~LinearAllocator() = default;
+
+		void* Allocate(size_t aSize, size_t aAlignment = alignof(std::max_align_t));
+
+		template<class T, class... Args>
+		T* New(Args&&... aArgs);
+
+		// Rewinds to the start, if the allocator had to grow the blocks are merged into one
+		// so the next round of allocations fits without growing again.
+		void Reset();
+
+		size_t GetUsedBytes() const;
+		size_t GetHighWaterMark() const;
+		size_t GetCapacity() const;
+		size_t GetBlockCount() const;
+
+	private:
+		struct Block
+		{
+			std::unique_ptr<uint8_t[]> myMemory;
+			size_t mySize;
+		};
+
+		void AddBlock(size_t aMinimumSize);
+
+		std::vector<Block> myBlocks;
+		size_t myBlockSize;
+		size_t myCurrentBlock;
+		size_t myOffset;
+		size_t myUsedBytes;
+		size_t myHighWaterMark;
+	};
+
+	// STL allocator that takes its memory from a LinearAllocator, deallocate does nothing.
+	template<class T>
+	class ArenaAllocator
+	{
+	public:
+		using value_type = T;
+
+		ArenaAllocator(LinearAllocator& aArena) noexcept : myArena(&aArena) {}
+
+		template<class U>
+		ArenaAllocator(const ArenaAllocator<U>& aOther) noexcept : myArena(aOther.myArena) {}
+
+		T* allocate(size_t aCount)
+		{
+			return static_cast<T*>(myArena->Allocate(aCount * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T* /*aPointer*/, size_t /*aCount*/) noexcept {}
+
+		template<class U>
+		bool operator==(const ArenaAllocator<U>& aOther) const noexcept { return myArena == aOther.myArena; }
+		template<class U>
+		bool operator!=(const ArenaAllocator<U>& aOther) const noexcept { return myArena != aOther.myArena; }
+
+	private:
+		template<class U> friend class ArenaAllocator;
+
+		LinearAllocator* myArena;
+	};
+
+	template<class T, class... Args>
+	inline T* LinearAllocator::New(Args&&... aArgs)
+	{
+		return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(aArgs)...);
+	}
+}
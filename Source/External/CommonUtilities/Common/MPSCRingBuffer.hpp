@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace CU
+{
+	// Bounded lock-free queue, any number of threads may push and one thread pops.
+	// Every cell carries a sequence number: a producer claims a slot by moving the write index with a
+	// compare-exchange and publishes it by bumping the cell's sequence, the consumer only reads cells
+	// whose sequence says they are published. Capacity has to be a power of two.
+	template<class T, size_t Capacity>
+	class MPSCRingBuffer
+	{
+		static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "MPSCRingBuffer capacity has to be a power of two");
+
+	public:
+		MPSCRingBuffer();
+		MPSCRingBuffer(const MPSCRingBuffer& aRingBuffer) = delete;
+		MPSCRingBuffer& operator=(const MPSCRingBuffer& aRingBuffer) = delete;
+
+		// Any thread, returns false without blocking when the buffer is full
+		bool TryPush(const T& aValue);
+
+		// Consumer thread only, returns false when nothing is published yet
+		bool TryPop(T& aOutValue);
+
+		static constexpr size_t GetCapacity() { return Capacity; }
+
+	private:
+		struct Cell
+		{
+			std::atomic<size_t> mySequence;
+			T myValue;
+		};
+
+		static constexpr size_t ourMask = Capacity - 1;
+
+		// Own cache lines so producers and the consumer do not invalidate each other's index
+		alignas(64) std::atomic<size_t> myWriteIndex;
+		alignas(64) size_t myReadIndex;
+		alignas(64) Cell myCells[Capacity];
+	};
+
+	template<class T, size_t Capacity>
+	inline MPSCRingBuffer<T, Capacity>::MPSCRingBuffer()
+		: myWriteIndex(0)
+		, myReadIndex(0)
+	{
+		for (size_t index = 0; index < Capacity; ++index)
+		{
+			myCells[index].mySequence.store(index, std::memory_order_relaxed);
+		}
+	}
+
+	template<class T, size_t Capacity>
+	inline bool MPSCRingBuffer<T, Capacity>::TryPush(const T& aValue)
+	{
+		size_t position = myWriteIndex.load(std::memory_order_relaxed);
+		Cell* cell = nullptr;
+		for (;;)
+		{
+			cell = &myCells[position & ourMask];
+			const size_t sequence = cell->mySequence.load(std::memory_order_acquire);
+			const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+			if (difference == 0)
+			{
+				// The cell is free for this lap, claim it
+				if (myWriteIndex.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				// The consumer has not freed the cell from the previous lap yet
+				return false;
+			}
+			else
+			{
+				position = myWriteIndex.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->myValue = aValue;
+		cell->mySequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<class T, size_t Capacity>
+	inline bool MPSCRingBuffer<T, Capacity>::TryPop(T& aOutValue)
+	{
+		Cell& cell = myCells[myReadIndex & ourMask];
+		if (cell.mySequence.load(std::memory_order_acquire) != myReadIndex + 1)
+		{
+			return false;
+		}
+
+		aOutValue = std::move(cell.myValue);
+		cell.mySequence.store(myReadIndex + Capacity, std::memory_order_release);
+		++myReadIndex;
+		return true;
+	}
+}
+
+namespace CommonUtilities = CU;
@@ -0,0 +1,70 @@
+#include "ThreadPool.h"
+
+CU::ThreadPool::ThreadPool(unsigned int aThreadCount)
+{
+	myIsStopping = false;
+
+	if (aThreadCount == 0)
+	{
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		aThreadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	myWorkers.reserve(aThreadCount);
+	for (unsigned int i = 0; i < aThreadCount; ++i)
+	{
+		myWorkers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+CU::ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(myMutex);
+		myIsStopping = true;
+	}
+	myJobAvailable.notify_all();
+
+	for (std::thread& worker : myWorkers)
+	{
+		worker.join();
+	}
+}
+
+std::future<void> CU::ThreadPool::Enqueue(std::function<void()> aJob)
+{
+	std::packaged_task<void()> task(std::move(aJob));
+	std::future<void> future = task.get_future();
+	{
+		std::lock_guard<std::mutex> lock(myMutex);
+		myJobs.push(std::move(task));
+	}
+	myJobAvailable.notify_one();
+	return future;
+}
+
+unsigned int CU::ThreadPool::GetThreadCount() const
+{
+	return static_cast<unsigned int>(myWorkers.size());
+}
+
+void CU::ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::packaged_task<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(myMutex);
+			myJobAvailable.wait(lock, [this] { return myIsStopping || !myJobs.empty(); });
+
+			// Finish queued jobs before stopping so no future is left without a result
+			if (myJobs.empty())
+			{
+				return;
+			}
+			task = std::move(myJobs.front());
+			myJobs.pop();
+		}
+		task();
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace CU
+{
+	class ThreadPool
+	{
+	public:
+		// Starts aThreadCount workers, 0 means one less than the number of hardware threads (at least one).
+		explicit ThreadPool(unsigned int aThreadCount = 0);
+		ThreadPool(const ThreadPool& aThreadPool) = delete;
+		ThreadPool& operator=(const ThreadPool& aThreadPool) = delete;
+		~ThreadPool();
+
+		// Queues aJob to run on a worker, the returned future is ready once the job has run.
+		std::future<void> Enqueue(std::function<void()> aJob);
+
+		unsigned int GetThreadCount() const;
+
+	private:
+		void WorkerLoop();
+
+		std::vector<std::thread> myWorkers;
+		std::queue<std::packaged_task<void()>> myJobs;
+
+		std::mutex myMutex;
+		std::condition_variable myJobAvailable;
+		bool myIsStopping;
+	};
+}
@@ -3,6 +3,7 @@
 namespace CU
 {
 	float Time::myTimeScale;
+	double Time::myFixedDeltaTime;
 
 	std::chrono::time_point<std::chrono::high_resolution_clock> Time::myStartPoint;
 	std::chrono::time_point<std::chrono::high_resolution_clock> Time::myLastTimePoint;
@@ -22,6 +23,7 @@ namespace CU
 		myStartPoint = std::chrono::high_resolution_clock::now();
 		myLastTimePoint = myStartPoint;
 		myTimeScale = 1.f;
+		myFixedDeltaTime = 0;
 
 		myDeltaTime = 0;
 		myDeltaTimeUnScaled = 0;
@@ -46,6 +48,14 @@ namespace CU
 		myTimeD += myDeltaTimeD;
 		myUnScaledTime += myDeltaTimeUnScaled;
 		myUnScaledTimeD += myDeltaTimeDUnScaled;
+
+		if (myFixedDeltaTime > 0)
+		{
+			myDeltaTimeDUnScaled = myFixedDeltaTime;
+			myDeltaTimeUnScaled = static_cast<float>(myDeltaTimeDUnScaled);
+			myDeltaTimeD = myDeltaTimeDUnScaled * static_cast<double>(myTimeScale);
+			myDeltaTime = static_cast<float>(myDeltaTimeD);
+		}
 	}
 
 	void Time::SetTimeScale(const float& aTimeScale)
@@ -58,6 +68,16 @@ namespace CU
 		return myTimeScale;
 	}
 
+	void Time::SetFixedDeltaTime(const double& aFixedDeltaTime)
+	{
+		myFixedDeltaTime = aFixedDeltaTime;
+	}
+
+	double Time::GetFixedDeltaTime()
+	{
+		return myFixedDeltaTime;
+	}
+
 	float Time::GetDeltaTime()
 	{
 		return myDeltaTime;
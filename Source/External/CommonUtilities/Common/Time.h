@@ -12,6 +12,11 @@ namespace CU
 		static void SetTimeScale(const float& aTimeScale);
 		static float GetTimeScale();
 
+		// When set (above 0) the delta time getters return this step instead of the measured frame time,
+		// for updates driven by a fixed timestep. Total time keeps following the real clock.
+		static void SetFixedDeltaTime(const double& aFixedDeltaTime);
+		static double GetFixedDeltaTime();
+
 		static float GetDeltaTime();
 		static float GetUnScaledDeltaTime();
 		
@@ -27,6 +32,7 @@ namespace CU
 	private:
 		
 		static float myTimeScale;
+		static double myFixedDeltaTime;
 		
 		static std::chrono::time_point<std::chrono::high_resolution_clock> myStartPoint;
 		static std::chrono::time_point<std::chrono::high_resolution_clock> myLastTimePoint;
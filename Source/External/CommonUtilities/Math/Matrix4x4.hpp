@@ -1,5 +1,7 @@
 #pragma once
 #include "Vector4.hpp"
+#include <cstring>
+#include <initializer_list>
 
 namespace CU
 {
@@ -12,6 +14,7 @@ namespace CU
 		
 		// Copy Constructor.
 		Matrix4x4<T>(const Matrix4x4<T>& aMatrix);
+		Matrix4x4<T>& operator=(const Matrix4x4<T>& aMatrix) = default;
 		
 		// Initializer list constructor (for teachers: used to just make rotation around axis creation easier)
 		Matrix4x4<T>(std::initializer_list<T> aList);
@@ -94,14 +97,14 @@ namespace CU
 	template<typename T>
 	inline T& Matrix4x4<T>::operator()(const int aRow, const int aColumn)
 	{
-		assert(aRow > 0 && aRow <= myMatrixSize && aColumn > 0 && aColumn <= myMatrixSize && "Indexes out of bounds");
+		assert(aRow > 0 && aRow <= static_cast<int>(myMatrixSize) && aColumn > 0 && aColumn <= static_cast<int>(myMatrixSize) && "Indexes out of bounds");
 		return myData[(aRow - 1) * 4 + (aColumn - 1)];
 	}
 
 	template<typename T>
 	inline const T& Matrix4x4<T>::operator()(const int aRow, const int aColumn) const
 	{
-		assert(aRow > 0 && aRow <= myMatrixSize && aColumn > 0 && aColumn <= myMatrixSize && "Indexes out of bounds");
+		assert(aRow > 0 && aRow <= static_cast<int>(myMatrixSize) && aColumn > 0 && aColumn <= static_cast<int>(myMatrixSize) && "Indexes out of bounds");
 		return myData[(aRow - 1) * 4 + (aColumn - 1)];
 	}
 
@@ -238,14 +241,14 @@ namespace CU
 	template<class T>
 	inline Vector4<T> Matrix4x4<T>::GetRow(const int& aRowIndex) const
 	{
-		assert(aRowIndex > 0 && aRowIndex <= myMatrixSize && "Index out of bounds");
+		assert(aRowIndex > 0 && aRowIndex <= static_cast<int>(myMatrixSize) && "Index out of bounds");
 		return Vector4<T>(myData[(aRowIndex - 1) * 4 + 0], myData[(aRowIndex - 1) * 4 + 1], myData[(aRowIndex - 1) * 4 + 2], myData[(aRowIndex - 1) * 4 + 3]);
 	}
 
 	template<class T>
 	inline Vector4<T> Matrix4x4<T>::GetColumn(const int& aColumnIndex) const
 	{
-		assert(aColumnIndex > 0 && aColumnIndex <= myMatrixSize && "Index out of bounds");
+		assert(aColumnIndex > 0 && aColumnIndex <= static_cast<int>(myMatrixSize) && "Index out of bounds");
 		int index = aColumnIndex - 1;
 		return Vector4<T>(myData[index], myData[4 + index], myData[8 + index], myData[12 + index]);
 	}
@@ -253,7 +256,7 @@ namespace CU
 	template<class T>
 	inline void Matrix4x4<T>::SetRow(const int& aRowIndex, const Vector4<T>& aVector)
 	{
-		assert(aRowIndex > 0 && aRowIndex <= myMatrixSize && "Index out of bounds");
+		assert(aRowIndex > 0 && aRowIndex <= static_cast<int>(myMatrixSize) && "Index out of bounds");
 		myData[(aRowIndex - 1) * 4 + 0] = aVector.x;
 		myData[(aRowIndex - 1) * 4 + 1] = aVector.y;
 		myData[(aRowIndex - 1) * 4 + 2] = aVector.z;
@@ -263,7 +266,7 @@ namespace CU
 	template<class T>
 	inline void Matrix4x4<T>::SetColumn(const int& aColumnIndex, const Vector4<T>& aVector)
 	{
-		assert(aColumnIndex > 0 && aColumnIndex <= myMatrixSize && "Index out of bounds");
+		assert(aColumnIndex > 0 && aColumnIndex <= static_cast<int>(myMatrixSize) && "Index out of bounds");
 		int index = aColumnIndex - 1;
 		myData[index] = aVector.x;
 		myData[4 + index] = aVector.y;
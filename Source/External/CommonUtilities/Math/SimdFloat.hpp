@@ -0,0 +1,170 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CU_SIMD_SSE
+#endif
+
+namespace CU
+{
+	// A register of floats for writing a kernel once: eight lanes with AVX, four with SSE2 and a
+	// four float array everywhere else. Comparisons return lanes with all bits set or clear, use them
+	// with &, SimdSelect or SimdMoveMask. SimdMin and SimdMax return the second value when a lane is NaN.
+	struct SimdFloat
+	{
+#if defined(__AVX__)
+		static constexpr size_t ourLaneCount = 8;
+		__m256 myValue;
+#elif defined(CU_SIMD_SSE)
+		static constexpr size_t ourLaneCount = 4;
+		__m128 myValue;
+#else
+		static constexpr size_t ourLaneCount = 4;
+		union
+		{
+			float myValue[ourLaneCount];
+			uint32_t myBits[ourLaneCount];
+		};
+#endif
+	};
+
+#if defined(__AVX__)
+	inline SimdFloat SimdLoad(const float* aValues) { return { _mm256_loadu_ps(aValues) }; }
+	inline void SimdStore(float* aOutValues, SimdFloat aValue) { _mm256_storeu_ps(aOutValues, aValue.myValue); }
+	inline SimdFloat SimdSet(float aValue) { return { _mm256_set1_ps(aValue) }; }
+	inline SimdFloat operator+(SimdFloat aFirst, SimdFloat aSecond) { return { _mm256_add_ps(aFirst.myValue, aSecond.myValue) }; }
+	inline SimdFloat operator-(SimdFloat aFirst, SimdFloat aSecond) { return { _mm256_sub_ps(aFirst.myValue, aSecond.myValue) }; }
+	inline SimdFloat operator*(SimdFloat aFirst, SimdFloat aSecond) { return { _mm256_mul_ps(aFirst.myValue, aSecond.myValue) }; }
+	inline SimdFloat operator&(SimdFloat aFirst, SimdFloat aSecond) { return { _mm256_and_ps(aFirst.myValue, aSecond.myValue) }; }
+	inline SimdFloat operator|(SimdFloat aFirst, SimdFloat aSecond) { return { _mm256_or_ps(aFirst.myValue, aSecond.myValue) }; }
+	inline SimdFloat SimdMin(SimdFloat aFirst, SimdFloat aSecond) { return { _mm256_min_ps(aFirst.myValue, aSecond.myValue) }; }
+	inline SimdFloat SimdMax(SimdFloat aFirst, SimdFloat aSecond) { return { _mm256_max_ps(aFirst.myValue, aSecond.myValue) }; }
+	inline SimdFloat SimdLess(SimdFloat aFirst, SimdFloat aSecond) { return { _mm256_cmp_ps(aFirst.myValue, aSecond.myValue, _CMP_LT_OQ) }; }
+	inline SimdFloat SimdLessEqual(SimdFloat aFirst, SimdFloat aSecond) { return { _mm256_cmp_ps(aFirst.myValue, aSecond.myValue, _CMP_LE_OQ) }; }
+	inline SimdFloat SimdSelect(SimdFloat aMask, SimdFloat aIfSet, SimdFloat aIfClear) { return { _mm256_blendv_ps(aIfClear.myValue, aIfSet.myValue, aMask.myValue) }; }
+	inline uint32_t SimdMoveMask(SimdFloat aMask) { return static_cast<uint32_t>(_mm256_movemask_ps(aMask.myValue)); }
+#elif defined(CU_SIMD_SSE)
+	inline SimdFloat SimdLoad(const float* aValues) { return { _mm_loadu_ps(aValues) }; }
+	inline void SimdStore(float* aOutValues, SimdFloat aValue) { _mm_storeu_ps(aOutValues, aValue.myValue); }
+	inline SimdFloat SimdSet(float aValue) { return { _mm_set1_ps(aValue) }; }
+	inline SimdFloat operator+(SimdFloat aFirst, SimdFloat aSecond) { return { _mm_add_ps(aFirst.myValue, aSecond.myValue) }; }
+	inline SimdFloat operator-(SimdFloat aFirst, SimdFloat aSecond) { return { _mm_sub_ps(aFirst.myValue, aSecond.myValue) }; }
+	inline SimdFloat operator*(SimdFloat aFirst, SimdFloat aSecond) { return { _mm_mul_ps(aFirst.myValue, aSecond.myValue) }; }
+	inline SimdFloat operator&(SimdFloat aFirst, SimdFloat aSecond) { return { _mm_and_ps(aFirst.myValue, aSecond.myValue) }; }
+	inline SimdFloat operator|(SimdFloat aFirst, SimdFloat aSecond) { return { _mm_or_ps(aFirst.myValue, aSecond.myValue) }; }
+	inline SimdFloat SimdMin(SimdFloat aFirst, SimdFloat aSecond) { return { _mm_min_ps(aFirst.myValue, aSecond.myValue) }; }
+	inline SimdFloat SimdMax(SimdFloat aFirst, SimdFloat aSecond) { return { _mm_max_ps(aFirst.myValue, aSecond.myValue) }; }
+	inline SimdFloat SimdLess(SimdFloat aFirst, SimdFloat aSecond) { return { _mm_cmplt_ps(aFirst.myValue, aSecond.myValue) }; }
+	inline SimdFloat SimdLessEqual(SimdFloat aFirst, SimdFloat aSecond) { return { _mm_cmple_ps(aFirst.myValue, aSecond.myValue) }; }
+	inline SimdFloat SimdSelect(SimdFloat aMask, SimdFloat aIfSet, SimdFloat aIfClear) { return { _mm_or_ps(_mm_and_ps(aMask.myValue, aIfSet.myValue), _mm_andnot_ps(aMask.myValue, aIfClear.myValue)) }; }
+	inline uint32_t SimdMoveMask(SimdFloat aMask) { return static_cast<uint32_t>(_mm_movemask_ps(aMask.myValue)); }
+#else
+	namespace SimdDetail
+	{
+		template<class Operation>
+		inline SimdFloat PerLane(SimdFloat aFirst, SimdFloat aSecond, Operation aOperation)
+		{
+			SimdFloat result;
+			for (size_t lane = 0; lane < SimdFloat::ourLaneCount; ++lane)
+			{
+				result.myValue[lane] = aOperation(aFirst.myValue[lane], aSecond.myValue[lane]);
+			}
+			return result;
+		}
+
+		template<class Operation>
+		inline SimdFloat PerLaneBits(SimdFloat aFirst, SimdFloat aSecond, Operation aOperation)
+		{
+			SimdFloat result;
+			for (size_t lane = 0; lane < SimdFloat::ourLaneCount; ++lane)
+			{
+				result.myBits[lane] = aOperation(aFirst, aSecond, lane);
+			}
+			return result;
+		}
+	}
+
+	inline SimdFloat SimdLoad(const float* aValues)
+	{
+		SimdFloat result;
+		for (size_t lane = 0; lane < SimdFloat::ourLaneCount; ++lane)
+		{
+			result.myValue[lane] = aValues[lane];
+		}
+		return result;
+	}
+
+	inline void SimdStore(float* aOutValues, SimdFloat aValue)
+	{
+		for (size_t lane = 0; lane < SimdFloat::ourLaneCount; ++lane)
+		{
+			aOutValues[lane] = aValue.myValue[lane];
+		}
+	}
+
+	inline SimdFloat SimdSet(float aValue)
+	{
+		SimdFloat result;
+		for (size_t lane = 0; lane < SimdFloat::ourLaneCount; ++lane)
+		{
+			result.myValue[lane] = aValue;
+		}
+		return result;
+	}
+
+	inline SimdFloat operator+(SimdFloat aFirst, SimdFloat aSecond) { return SimdDetail::PerLane(aFirst, aSecond, [](float aA, float aB) { return aA + aB; }); }
+	inline SimdFloat operator-(SimdFloat aFirst, SimdFloat aSecond) { return SimdDetail::PerLane(aFirst, aSecond, [](float aA, float aB) { return aA - aB; }); }
+	inline SimdFloat operator*(SimdFloat aFirst, SimdFloat aSecond) { return SimdDetail::PerLane(aFirst, aSecond, [](float aA, float aB) { return aA * aB; }); }
+	inline SimdFloat SimdMin(SimdFloat aFirst, SimdFloat aSecond) { return SimdDetail::PerLane(aFirst, aSecond, [](float aA, float aB) { return aA < aB ? aA : aB; }); }
+	inline SimdFloat SimdMax(SimdFloat aFirst, SimdFloat aSecond) { return SimdDetail::PerLane(aFirst, aSecond, [](float aA, float aB) { return aA > aB ? aA : aB; }); }
+
+	inline SimdFloat operator&(SimdFloat aFirst, SimdFloat aSecond)
+	{
+		return SimdDetail::PerLaneBits(aFirst, aSecond, [](const SimdFloat& aA, const SimdFloat& aB, size_t aLane) { return aA.myBits[aLane] & aB.myBits[aLane]; });
+	}
+
+	inline SimdFloat operator|(SimdFloat aFirst, SimdFloat aSecond)
+	{
+		return SimdDetail::PerLaneBits(aFirst, aSecond, [](const SimdFloat& aA, const SimdFloat& aB, size_t aLane) { return aA.myBits[aLane] | aB.myBits[aLane]; });
+	}
+
+	inline SimdFloat SimdLess(SimdFloat aFirst, SimdFloat aSecond)
+	{
+		return SimdDetail::PerLaneBits(aFirst, aSecond, [](const SimdFloat& aA, const SimdFloat& aB, size_t aLane) { return aA.myValue[aLane] < aB.myValue[aLane] ? UINT32_MAX : 0u; });
+	}
+
+	inline SimdFloat SimdLessEqual(SimdFloat aFirst, SimdFloat aSecond)
+	{
+		return SimdDetail::PerLaneBits(aFirst, aSecond, [](const SimdFloat& aA, const SimdFloat& aB, size_t aLane) { return aA.myValue[aLane] <= aB.myValue[aLane] ? UINT32_MAX : 0u; });
+	}
+
+	inline SimdFloat SimdSelect(SimdFloat aMask, SimdFloat aIfSet, SimdFloat aIfClear)
+	{
+		SimdFloat result;
+		for (size_t lane = 0; lane < SimdFloat::ourLaneCount; ++lane)
+		{
+			result.myValue[lane] = aMask.myBits[lane] ? aIfSet.myValue[lane] : aIfClear.myValue[lane];
+		}
+		return result;
+	}
+
+	inline uint32_t SimdMoveMask(SimdFloat aMask)
+	{
+		uint32_t mask = 0;
+		for (size_t lane = 0; lane < SimdFloat::ourLaneCount; ++lane)
+		{
+			mask |= (aMask.myBits[lane] >> 31) << lane;
+		}
+		return mask;
+	}
+#endif
+
+	inline SimdFloat SimdGreater(SimdFloat aFirst, SimdFloat aSecond) { return SimdLess(aSecond, aFirst); }
+	inline SimdFloat SimdGreaterEqual(SimdFloat aFirst, SimdFloat aSecond) { return SimdLessEqual(aSecond, aFirst); }
+}
+
+namespace CommonUtilities = CU;
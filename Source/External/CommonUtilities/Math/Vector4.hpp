@@ -2,6 +2,7 @@
 #include <cmath>
 #include <string>
 #include <cassert>
+#include "Math.hpp"
 
 namespace CU
 {
@@ -1,25 +1,31 @@
 #include "stdafx.h"
 
 #include "AABBCollider.h"
+#include "ColliderWorld.h"
 
 #include <tge/drawers/DebugDrawer.h>
 #include <tge/graphics/GraphicsEngine.h>
 
+#include <cassert>
+#include <cfloat>
+
 AABBCollider::AABBCollider()
 {
-	
+	UpdateExtents();
 }
 
 AABBCollider::AABBCollider(float aX, float aY, float aWidth, float aHeight)
 {
 	myPosition = Tga::Vector2f(aX, aY);
 	mySize = Tga::Vector2f(aWidth, aHeight);
+	UpdateExtents();
 }
 
 AABBCollider::AABBCollider(const Tga::Vector2f& aPosition, const Tga::Vector2f& aSize)
 {
 	myPosition = aPosition;
 	mySize = aSize;
+	UpdateExtents();
 }
 
 AABBCollider::AABBCollider(const Tga::Vector2f& aPosition, const Tga::Vector2f& aSize, const Tga::Vector2f& aPivot)
@@ -27,24 +33,113 @@ AABBCollider::AABBCollider(const Tga::Vector2f& aPosition, const Tga::Vector2f&
 	myPosition = aPosition;
 	mySize = aSize;
 	myPivot = aPivot;
+	UpdateExtents();
+}
+
+AABBCollider::AABBCollider(const AABBCollider& aOtherCollider)
+	: myLayer(aOtherCollider.myLayer)
+	, myCollisionMask(aOtherCollider.myCollisionMask)
+	, myPosition(aOtherCollider.myPosition)
+	, mySize(aOtherCollider.mySize)
+	, myPivot(aOtherCollider.myPivot)
+	, myMin(aOtherCollider.myMin)
+	, myMax(aOtherCollider.myMax)
+{
+}
+
+AABBCollider& AABBCollider::operator=(const AABBCollider& aOtherCollider)
+{
+	SetRect(aOtherCollider.myPosition, aOtherCollider.mySize, aOtherCollider.myPivot);
+	SetLayer(aOtherCollider.myLayer);
+	SetCollisionMask(aOtherCollider.myCollisionMask);
+	return *this;
 }
 
 AABBCollider::~AABBCollider()
 {
+	if (myWorld)
+	{
+		myWorld->Remove(*this);
+	}
 }
 
 bool AABBCollider::CheckCollision(const AABBCollider& aOtherCollider) const
 {
-	if ((myPosition.x - myPivot.x * mySize.x) + mySize.x >= aOtherCollider.myPosition.x - aOtherCollider.myPivot.x * aOtherCollider.mySize.x
-		&& (myPosition.x - myPivot.x * mySize.x) <= (aOtherCollider.myPosition.x - aOtherCollider.myPivot.x * aOtherCollider.mySize.x) + aOtherCollider.mySize.x
-		&& (myPosition.y - myPivot.y * mySize.y) + mySize.y >= aOtherCollider.myPosition.y - aOtherCollider.myPivot.y * aOtherCollider.mySize.y
-		&& (myPosition.y - myPivot.y * mySize.y) <= (aOtherCollider.myPosition.y - aOtherCollider.myPivot.y * aOtherCollider.mySize.y) + aOtherCollider.mySize.y)
+	if (myMax.x >= aOtherCollider.myMin.x
+		&& myMin.x <= aOtherCollider.myMax.x
+		&& myMax.y >= aOtherCollider.myMin.y
+		&& myMin.y <= aOtherCollider.myMax.y)
 	{
 		return true;
 	}
 	return false;
 }
 
+bool AABBCollider::Sweep(const Tga::Vector2f& aDisplacement, const AABBCollider& aOtherCollider, SweepHit& aOutHit) const
+{
+	return Sweep(myMin, myMax, aDisplacement, aOtherCollider.myMin, aOtherCollider.myMax, aOutHit);
+}
+
+bool AABBCollider::Sweep(const Tga::Vector2f& aMin, const Tga::Vector2f& aMax, const Tga::Vector2f& aDisplacement, const Tga::Vector2f& aOtherMin, const Tga::Vector2f& aOtherMax, SweepHit& aOutHit)
+{
+	// Slabs of the Minkowski difference: on each axis the time the moving box starts and stops overlapping
+	float entry[2];
+	float exit[2];
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		const float min = axis == 0 ? aMin.x : aMin.y;
+		const float max = axis == 0 ? aMax.x : aMax.y;
+		const float otherMin = axis == 0 ? aOtherMin.x : aOtherMin.y;
+		const float otherMax = axis == 0 ? aOtherMax.x : aOtherMax.y;
+		const float displacement = axis == 0 ? aDisplacement.x : aDisplacement.y;
+
+		if (displacement == 0.0f)
+		{
+			if (max <= otherMin || min >= otherMax)
+			{
+				return false;
+			}
+			entry[axis] = -FLT_MAX;
+			exit[axis] = FLT_MAX;
+		}
+		else if (displacement > 0.0f)
+		{
+			entry[axis] = (otherMin - max) / displacement;
+			exit[axis] = (otherMax - min) / displacement;
+		}
+		else
+		{
+			entry[axis] = (otherMax - min) / displacement;
+			exit[axis] = (otherMin - max) / displacement;
+		}
+	}
+
+	const float entryTime = entry[0] > entry[1] ? entry[0] : entry[1];
+	const float exitTime = exit[0] < exit[1] ? exit[0] : exit[1];
+	if (entryTime >= exitTime || entryTime > 1.0f || exitTime <= 0.0f)
+	{
+		return false;
+	}
+
+	if (entryTime < 0.0f)
+	{
+		aOutHit.myTime = 0.0f;
+		aOutHit.myNormal = Tga::Vector2f(0.0f, 0.0f);
+		return true;
+	}
+
+	aOutHit.myTime = entryTime;
+	if (entry[0] >= entry[1])
+	{
+		aOutHit.myNormal = Tga::Vector2f(aDisplacement.x > 0.0f ? -1.0f : 1.0f, 0.0f);
+	}
+	else
+	{
+		aOutHit.myNormal = Tga::Vector2f(0.0f, aDisplacement.y > 0.0f ? -1.0f : 1.0f);
+	}
+	return true;
+}
+
 Tga::Vector2f AABBCollider::GetPosition() const
 {
 	return myPosition;
@@ -53,6 +148,11 @@ Tga::Vector2f AABBCollider::GetPosition() const
 void AABBCollider::SetPosition(const Tga::Vector2f& aPosition)
 {
 	myPosition = aPosition;
+	UpdateExtents();
+	if (myWorld)
+	{
+		myWorld->Update(*this);
+	}
 }
 
 void AABBCollider::SetRect(const Tga::Vector2f& aPosition, const Tga::Vector2f& aSize, const Tga::Vector2f& aPivot)
@@ -60,6 +160,38 @@ void AABBCollider::SetRect(const Tga::Vector2f& aPosition, const Tga::Vector2f&
 	myPosition = aPosition;
 	mySize = aSize;
 	myPivot = aPivot;
+	UpdateExtents();
+	if (myWorld)
+	{
+		myWorld->Update(*this);
+	}
+}
+
+void AABBCollider::SetLayer(uint32_t aLayer)
+{
+	assert(aLayer < 32 && "Collider layers go from 0 to 31");
+	if (myLayer == aLayer)
+	{
+		return;
+	}
+	myLayer = aLayer;
+	if (myWorld)
+	{
+		myWorld->UpdateFilter(*this);
+	}
+}
+
+void AABBCollider::SetCollisionMask(uint32_t aMask)
+{
+	if (myCollisionMask == aMask)
+	{
+		return;
+	}
+	myCollisionMask = aMask;
+	if (myWorld)
+	{
+		myWorld->UpdateFilter(*this);
+	}
 }
 
 void AABBCollider::DebugRender()
@@ -98,4 +230,20 @@ Tga::Vector2f AABBCollider::GetBottomLeft() const
 Tga::Vector2f AABBCollider::GetBottomRight() const
 {
 	return Tga::Vector2(myPosition.x + (1 - myPivot.x) * mySize.x, myPosition.y - (1 - myPivot.y) * mySize.y);
-}
\ No newline at end of file
+}
+
+Tga::Vector2f AABBCollider::GetMin() const
+{
+	return myMin;
+}
+
+Tga::Vector2f AABBCollider::GetMax() const
+{
+	return myMax;
+}
+
+void AABBCollider::UpdateExtents()
+{
+	myMin = Tga::Vector2f(myPosition.x - myPivot.x * mySize.x, myPosition.y - myPivot.y * mySize.y);
+	myMax = myMin + mySize;
+}
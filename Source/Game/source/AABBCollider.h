@@ -1,5 +1,16 @@
 #pragma once
 #include <tge/math/vector2.h>
+#include <cstdint>
+
+class ColliderWorld;
+
+struct SweepHit
+{
+	// Fraction of the displacement travelled before contact, 0 when the boxes already overlap
+	float myTime = 1.0f;
+	// Points out of the surface that was hit, zero when the boxes already overlap
+	Tga::Vector2f myNormal;
+};
 
 class AABBCollider
 {
@@ -8,10 +19,19 @@ public:
 	AABBCollider(float aX, float aY, float aWidth, float aHeight);
 	AABBCollider(const Tga::Vector2f& aPosition, const Tga::Vector2f& aSize);
 	AABBCollider(const Tga::Vector2f& aPosition, const Tga::Vector2f& aSize, const Tga::Vector2f& aPivot);
+	// Copies the shape and collision filter, the copy is not part of the original's ColliderWorld
+	AABBCollider(const AABBCollider& aOtherCollider);
+	AABBCollider& operator=(const AABBCollider& aOtherCollider);
 	~AABBCollider();
 
 	bool CheckCollision(const AABBCollider& aOtherCollider) const;
 
+	// Continuous test of this collider moving by aDisplacement against aOtherCollider standing still,
+	// pass the difference of the displacements when both move. Boxes that only touch and slide along
+	// each other, or move apart, do not hit.
+	bool Sweep(const Tga::Vector2f& aDisplacement, const AABBCollider& aOtherCollider, SweepHit& aOutHit) const;
+	static bool Sweep(const Tga::Vector2f& aMin, const Tga::Vector2f& aMax, const Tga::Vector2f& aDisplacement, const Tga::Vector2f& aOtherMin, const Tga::Vector2f& aOtherMax, SweepHit& aOutHit);
+
 	Tga::Vector2f GetPosition() const;
 	void SetPosition(const Tga::Vector2f& aPosition);
 	
@@ -24,9 +44,35 @@ public:
 	Tga::Vector2f GetBottomLeft() const;
 	Tga::Vector2f GetBottomRight() const;
 
+	// Corners in the space CheckCollision tests in
+	Tga::Vector2f GetMin() const;
+	Tga::Vector2f GetMax() const;
+
+	// Layer 0 to 31 this collider is on, and a bit per layer it collides with. A pair is only reported
+	// when both accept the other's layer and the ColliderWorld's layer matrix allows the two layers.
+	void SetLayer(uint32_t aLayer);
+	uint32_t GetLayer() const { return myLayer; }
+	void SetCollisionMask(uint32_t aMask);
+	uint32_t GetCollisionMask() const { return myCollisionMask; }
+
+	// The world this collider was added to, nullptr if none
+	ColliderWorld* GetWorld() const { return myWorld; }
+
 private:
+	friend class ColliderWorld;
+
+	void UpdateExtents();
+
+	ColliderWorld* myWorld = nullptr;
+	uint32_t myWorldIndex = 0;
+	uint32_t myLayer = 0;
+	uint32_t myCollisionMask = ~0u;
+
 	Tga::Vector2f myPosition;
 	Tga::Vector2f mySize;
 	Tga::Vector2f myPivot;
+	// position - pivot * size and min + size, kept up to date so tests do not recompute them
+	Tga::Vector2f myMin;
+	Tga::Vector2f myMax;
 };
 
@@ -0,0 +1,199 @@
+#include "ColliderBatch.h"
+#include "AABBCollider.h"
+
+#include <cfloat>
+#include <limits>
+
+uint32_t ColliderBatch::Add(const AABBCollider& aCollider)
+{
+	const size_t index = myColliders.size();
+	myColliders.push_back(&aCollider);
+
+	// Grow a whole block at a time, the unused lanes are min +max and max -max and never overlap
+	if (index == myMinX.size())
+	{
+		const size_t size = index + ourLaneCount;
+		myMinX.resize(size, std::numeric_limits<float>::max());
+		myMinY.resize(size, std::numeric_limits<float>::max());
+		myMaxX.resize(size, -std::numeric_limits<float>::max());
+		myMaxY.resize(size, -std::numeric_limits<float>::max());
+	}
+
+	SetExtents(index, aCollider);
+	return static_cast<uint32_t>(index);
+}
+
+void ColliderBatch::Clear()
+{
+	myColliders.clear();
+	myMinX.clear();
+	myMinY.clear();
+	myMaxX.clear();
+	myMaxY.clear();
+}
+
+void ColliderBatch::Refresh()
+{
+	for (size_t index = 0; index < myColliders.size(); ++index)
+	{
+		SetExtents(index, *myColliders[index]);
+	}
+}
+
+uint32_t ColliderBatch::GetOverlapMask(const Tga::Vector2f& aMin, const Tga::Vector2f& aMax, size_t aFirst) const
+{
+	using namespace CU;
+
+	// Same inclusive test as AABBCollider::CheckCollision
+	const SimdFloat overlapX = SimdLessEqual(SimdLoad(&myMinX[aFirst]), SimdSet(aMax.x)) & SimdGreaterEqual(SimdLoad(&myMaxX[aFirst]), SimdSet(aMin.x));
+	const SimdFloat overlapY = SimdLessEqual(SimdLoad(&myMinY[aFirst]), SimdSet(aMax.y)) & SimdGreaterEqual(SimdLoad(&myMaxY[aFirst]), SimdSet(aMin.y));
+	return SimdMoveMask(overlapX & overlapY);
+}
+
+void ColliderBatch::Query(const Tga::Vector2f& aMin, const Tga::Vector2f& aMax, std::vector<uint32_t>& aOutIndices) const
+{
+	aOutIndices.clear();
+
+	for (size_t first = 0; first < myMinX.size(); first += ourLaneCount)
+	{
+		uint32_t mask = GetOverlapMask(aMin, aMax, first);
+		for (uint32_t lane = 0; mask != 0; ++lane, mask >>= 1)
+		{
+			if (mask & 1)
+			{
+				aOutIndices.push_back(static_cast<uint32_t>(first) + lane);
+			}
+		}
+	}
+}
+
+void ColliderBatch::Query(const AABBCollider& aCollider, std::vector<uint32_t>& aOutIndices) const
+{
+	Query(aCollider.GetMin(), aCollider.GetMax(), aOutIndices);
+}
+
+uint32_t ColliderBatch::Sweep(const Tga::Vector2f& aMin, const Tga::Vector2f& aMax, const Tga::Vector2f& aDisplacement, SweepHit& aOutHit, uint32_t aIgnore) const
+{
+	using namespace CU;
+
+	uint32_t hitIndex = ourNoHit;
+	aOutHit = SweepHit();
+
+	// The displacement is the same for every lane, so the per axis branches of AABBCollider::Sweep are taken once
+	const bool isStillX = aDisplacement.x == 0.0f;
+	const bool isStillY = aDisplacement.y == 0.0f;
+	const SimdFloat inverseX = SimdSet(isStillX ? 0.0f : 1.0f / aDisplacement.x);
+	const SimdFloat inverseY = SimdSet(isStillY ? 0.0f : 1.0f / aDisplacement.y);
+	const SimdFloat minX = SimdSet(aMin.x);
+	const SimdFloat minY = SimdSet(aMin.y);
+	const SimdFloat maxX = SimdSet(aMax.x);
+	const SimdFloat maxY = SimdSet(aMax.y);
+	const SimdFloat lowest = SimdSet(-FLT_MAX);
+	const SimdFloat highest = SimdSet(FLT_MAX);
+	const SimdFloat one = SimdSet(1.0f);
+	const SimdFloat zero = SimdSet(0.0f);
+	const SimdFloat all = SimdLessEqual(zero, zero);
+
+	for (size_t first = 0; first < myMinX.size(); first += ourLaneCount)
+	{
+		const SimdFloat otherMinX = SimdLoad(&myMinX[first]);
+		const SimdFloat otherMinY = SimdLoad(&myMinY[first]);
+		const SimdFloat otherMaxX = SimdLoad(&myMaxX[first]);
+		const SimdFloat otherMaxY = SimdLoad(&myMaxY[first]);
+
+		SimdFloat entryX = lowest;
+		SimdFloat exitX = highest;
+		SimdFloat validX = all;
+		if (isStillX)
+		{
+			validX = SimdLess(otherMinX, maxX) & SimdGreater(otherMaxX, minX);
+		}
+		else
+		{
+			const SimdFloat toMin = (otherMinX - maxX) * inverseX;
+			const SimdFloat toMax = (otherMaxX - minX) * inverseX;
+			entryX = aDisplacement.x > 0.0f ? toMin : toMax;
+			exitX = aDisplacement.x > 0.0f ? toMax : toMin;
+		}
+
+		SimdFloat entryY = lowest;
+		SimdFloat exitY = highest;
+		SimdFloat validY = all;
+		if (isStillY)
+		{
+			validY = SimdLess(otherMinY, maxY) & SimdGreater(otherMaxY, minY);
+		}
+		else
+		{
+			const SimdFloat toMin = (otherMinY - maxY) * inverseY;
+			const SimdFloat toMax = (otherMaxY - minY) * inverseY;
+			entryY = aDisplacement.y > 0.0f ? toMin : toMax;
+			exitY = aDisplacement.y > 0.0f ? toMax : toMin;
+		}
+
+		const SimdFloat entry = SimdMax(entryX, entryY);
+		const SimdFloat exit = SimdMin(exitX, exitY);
+		const SimdFloat hit = validX & validY & SimdLess(entry, exit) & SimdLessEqual(entry, one) & SimdGreater(exit, zero);
+
+		uint32_t mask = SimdMoveMask(hit);
+		if (mask == 0)
+		{
+			continue;
+		}
+
+		float times[ourLaneCount];
+		SimdStore(times, SimdMax(entry, zero));
+		const uint32_t isEntryX = SimdMoveMask(SimdGreaterEqual(entryX, entryY));
+		const uint32_t isOverlapping = SimdMoveMask(SimdLess(entry, zero));
+
+		for (uint32_t lane = 0; mask != 0; ++lane, mask >>= 1)
+		{
+			const uint32_t index = static_cast<uint32_t>(first) + lane;
+			if (!(mask & 1) || index == aIgnore || (hitIndex != ourNoHit && times[lane] >= aOutHit.myTime))
+			{
+				continue;
+			}
+
+			hitIndex = index;
+			aOutHit.myTime = times[lane];
+			if (isOverlapping & (1u << lane))
+			{
+				aOutHit.myNormal = Tga::Vector2f(0.0f, 0.0f);
+			}
+			else if (isEntryX & (1u << lane))
+			{
+				aOutHit.myNormal = Tga::Vector2f(aDisplacement.x > 0.0f ? -1.0f : 1.0f, 0.0f);
+			}
+			else
+			{
+				aOutHit.myNormal = Tga::Vector2f(0.0f, aDisplacement.y > 0.0f ? -1.0f : 1.0f);
+			}
+		}
+	}
+
+	return hitIndex;
+}
+
+void ColliderBatch::Sweep(const ColliderBatch& aMoving, const std::vector<Tga::Vector2f>& aDisplacements, std::vector<BatchSweepHit>& aOutHits) const
+{
+	aOutHits.resize(aMoving.size());
+	for (uint32_t moving = 0; moving < aMoving.size(); ++moving)
+	{
+		const Tga::Vector2f min(aMoving.myMinX[moving], aMoving.myMinY[moving]);
+		const Tga::Vector2f max(aMoving.myMaxX[moving], aMoving.myMaxY[moving]);
+
+		SweepHit hit;
+		const uint32_t index = Sweep(min, max, aDisplacements[moving], hit, &aMoving == this ? moving : ourNoHit);
+		aOutHits[moving] = { hit.myTime, hit.myNormal, index };
+	}
+}
+
+void ColliderBatch::SetExtents(size_t aIndex, const AABBCollider& aCollider)
+{
+	const Tga::Vector2f min = aCollider.GetMin();
+	const Tga::Vector2f max = aCollider.GetMax();
+	myMinX[aIndex] = min.x;
+	myMinY[aIndex] = min.y;
+	myMaxX[aIndex] = max.x;
+	myMaxY[aIndex] = max.y;
+}
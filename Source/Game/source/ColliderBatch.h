@@ -0,0 +1,63 @@
+#pragma once
+#include <tge/math/vector2.h>
+#include <CommonUtilities/Math/SimdFloat.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class AABBCollider;
+struct SweepHit;
+
+// Structure of arrays copy of AABBCollider extents for testing one box against many at once.
+// Each CU::SimdFloat operation tests ourLaneCount boxes, results come back as bitmasks. The batch keeps
+// pointers to the added colliders, call Refresh after they move.
+class ColliderBatch
+{
+public:
+	static constexpr size_t ourLaneCount = CU::SimdFloat::ourLaneCount;
+	static constexpr uint32_t ourNoHit = UINT32_MAX;
+
+	struct BatchSweepHit
+	{
+		float myTime;
+		Tga::Vector2f myNormal;
+		// Box in this batch that was hit first, ourNoHit when nothing was
+		uint32_t myIndex;
+	};
+
+	// Returns the index used in the results
+	uint32_t Add(const AABBCollider& aCollider);
+	void Clear();
+
+	// Copies the current extents of every added collider
+	void Refresh();
+
+	// Bit n is set when box aFirst + n overlaps the given box. aFirst has to be a multiple of ourLaneCount.
+	uint32_t GetOverlapMask(const Tga::Vector2f& aMin, const Tga::Vector2f& aMax, size_t aFirst) const;
+
+	// Indices of every box overlapping the given box, in order. Replaces the content of aOutIndices.
+	void Query(const Tga::Vector2f& aMin, const Tga::Vector2f& aMax, std::vector<uint32_t>& aOutIndices) const;
+	void Query(const AABBCollider& aCollider, std::vector<uint32_t>& aOutIndices) const;
+
+	// First box the given box hits while moving by aDisplacement, same rules as AABBCollider::Sweep.
+	// Returns ourNoHit when it hits nothing, box aIgnore is skipped.
+	uint32_t Sweep(const Tga::Vector2f& aMin, const Tga::Vector2f& aMax, const Tga::Vector2f& aDisplacement, SweepHit& aOutHit, uint32_t aIgnore = ourNoHit) const;
+
+	// First hit of each of aMoving's boxes moving by aDisplacements[index] against this batch.
+	// aMoving may be this batch, boxes do not hit themselves. Replaces the content of aOutHits.
+	void Sweep(const ColliderBatch& aMoving, const std::vector<Tga::Vector2f>& aDisplacements, std::vector<BatchSweepHit>& aOutHits) const;
+
+	const AABBCollider& GetCollider(uint32_t aIndex) const { return *myColliders[aIndex]; }
+	size_t size() const { return myColliders.size(); }
+
+private:
+	void SetExtents(size_t aIndex, const AABBCollider& aCollider);
+
+	std::vector<const AABBCollider*> myColliders;
+	// Padded to a multiple of ourLaneCount with boxes that overlap nothing
+	std::vector<float> myMinX;
+	std::vector<float> myMinY;
+	std::vector<float> myMaxX;
+	std::vector<float> myMaxY;
+};
@@ -0,0 +1,640 @@
+#include "ColliderWorld.h"
+#include "AABBCollider.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <iterator>
+
+bool ColliderWorld::CellRange::operator==(const CellRange& aOther) const
+{
+	return myMinX == aOther.myMinX && myMinY == aOther.myMinY && myMaxX == aOther.myMaxX && myMaxY == aOther.myMaxY;
+}
+
+ColliderWorld::ColliderWorld(float aCellSize, ColliderBroadphase aBroadphase)
+	: myBroadphase(aBroadphase)
+	, myCellSize(aCellSize)
+	, myInverseCellSize(1.0f / aCellSize)
+{
+	std::fill(std::begin(myLayerMatrix), std::end(myLayerMatrix), ~0u);
+}
+
+ColliderWorld::ColliderWorld(ColliderBroadphase aBroadphase)
+	: ColliderWorld(64.0f, aBroadphase)
+{
+}
+
+ColliderWorld::~ColliderWorld()
+{
+	for (Proxy& proxy : myProxies)
+	{
+		if (proxy.myCollider)
+		{
+			proxy.myCollider->myWorld = nullptr;
+		}
+	}
+}
+
+void ColliderWorld::Add(AABBCollider& aCollider)
+{
+	if (aCollider.myWorld == this)
+	{
+		return;
+	}
+	if (aCollider.myWorld)
+	{
+		aCollider.myWorld->Remove(aCollider);
+	}
+
+	uint32_t index;
+	if (!myFreeProxies.empty())
+	{
+		index = myFreeProxies.back();
+		myFreeProxies.pop_back();
+	}
+	else
+	{
+		index = static_cast<uint32_t>(myProxies.size());
+		myProxies.emplace_back();
+	}
+
+	Proxy& proxy = myProxies[index];
+	proxy.myCollider = &aCollider;
+	proxy.myMin = aCollider.GetMin();
+	proxy.myMax = aCollider.GetMax();
+	proxy.myLayer = aCollider.myLayer;
+	proxy.myCollisionMask = aCollider.myCollisionMask;
+
+	aCollider.myWorld = this;
+	aCollider.myWorldIndex = index;
+
+	if (myBroadphase == ColliderBroadphase::SweepAndPrune)
+	{
+		const float min[2] = { proxy.myMin.x, proxy.myMin.y };
+		const float max[2] = { proxy.myMax.x, proxy.myMax.y };
+		proxy.mySweepProxy = mySweepAndPrune.Add(min, max, &aCollider);
+		return;
+	}
+
+	proxy.myCells = GetCellRange(proxy.myMin, proxy.myMax);
+	InsertIntoCells(index);
+}
+
+void ColliderWorld::Remove(AABBCollider& aCollider)
+{
+	if (aCollider.myWorld != this)
+	{
+		return;
+	}
+
+	const uint32_t index = aCollider.myWorldIndex;
+	if (myBroadphase == ColliderBroadphase::SweepAndPrune)
+	{
+		mySweepAndPrune.Remove(myProxies[index].mySweepProxy);
+		myProxies[index].mySweepProxy = -1;
+	}
+	else
+	{
+		RemoveFromCells(index);
+	}
+	myProxies[index].myCollider = nullptr;
+	myFreeProxies.push_back(index);
+
+	aCollider.myWorld = nullptr;
+}
+
+void ColliderWorld::Update(AABBCollider& aCollider)
+{
+	const uint32_t index = aCollider.myWorldIndex;
+	Proxy& proxy = myProxies[index];
+	proxy.myMin = aCollider.GetMin();
+	proxy.myMax = aCollider.GetMax();
+
+	if (myBroadphase == ColliderBroadphase::SweepAndPrune)
+	{
+		const float min[2] = { proxy.myMin.x, proxy.myMin.y };
+		const float max[2] = { proxy.myMax.x, proxy.myMax.y };
+		mySweepAndPrune.Move(proxy.mySweepProxy, min, max);
+		return;
+	}
+
+	// Most moves stay inside the same cells, then only the cached bounds change
+	const CellRange cells = GetCellRange(proxy.myMin, proxy.myMax);
+	if (cells == proxy.myCells && IsOversized(cells, proxy.myMin, proxy.myMax) == proxy.myIsOversized)
+	{
+		return;
+	}
+
+	RemoveFromCells(index);
+	proxy.myCells = cells;
+	InsertIntoCells(index);
+}
+
+void ColliderWorld::UpdateFilter(AABBCollider& aCollider)
+{
+	Proxy& proxy = myProxies[aCollider.myWorldIndex];
+	proxy.myLayer = aCollider.myLayer;
+	proxy.myCollisionMask = aCollider.myCollisionMask;
+	myHasFilterChanged = true;
+}
+
+template<class Callback>
+void ColliderWorld::ForEachCandidatePair(Callback&& aCallback) const
+{
+	for (const auto& cell : myCells)
+	{
+		const std::vector<uint32_t>& indices = cell.second;
+		for (size_t first = 0; first < indices.size(); ++first)
+		{
+			const Proxy& firstProxy = myProxies[indices[first]];
+			for (size_t second = first + 1; second < indices.size(); ++second)
+			{
+				const Proxy& secondProxy = myProxies[indices[second]];
+
+				// Two colliders can share several cells, only the lowest shared cell reports them
+				const int sharedX = std::max(firstProxy.myCells.myMinX, secondProxy.myCells.myMinX);
+				const int sharedY = std::max(firstProxy.myCells.myMinY, secondProxy.myCells.myMinY);
+				if (GetCellKey(sharedX, sharedY) != cell.first)
+				{
+					continue;
+				}
+
+				if (Accepts(firstProxy, secondProxy))
+				{
+					aCallback(firstProxy, secondProxy);
+				}
+			}
+		}
+	}
+
+	// Oversized colliders pair with every collider in the grid and with the oversized ones after them
+	for (size_t first = 0; first < myOversizedProxies.size(); ++first)
+	{
+		const Proxy& firstProxy = myProxies[myOversizedProxies[first]];
+		for (const Proxy& secondProxy : myProxies)
+		{
+			if (secondProxy.myCollider && !secondProxy.myIsOversized && Accepts(firstProxy, secondProxy))
+			{
+				aCallback(firstProxy, secondProxy);
+			}
+		}
+		for (size_t second = first + 1; second < myOversizedProxies.size(); ++second)
+		{
+			const Proxy& secondProxy = myProxies[myOversizedProxies[second]];
+			if (Accepts(firstProxy, secondProxy))
+			{
+				aCallback(firstProxy, secondProxy);
+			}
+		}
+	}
+}
+
+void ColliderWorld::FindOverlappingPairs(std::vector<ColliderPair>& aOutPairs) const
+{
+	aOutPairs.clear();
+
+	if (myBroadphase == ColliderBroadphase::SweepAndPrune)
+	{
+		mySweepAndPrune.ForEachPair([this, &aOutPairs](AABBCollider* aFirst, AABBCollider* aSecond)
+		{
+			if (Accepts(*aFirst, *aSecond))
+			{
+				aOutPairs.push_back({ aFirst, aSecond });
+			}
+		});
+		return;
+	}
+
+	ForEachCandidatePair([&aOutPairs](const Proxy& aFirst, const Proxy& aSecond)
+	{
+		if (Overlaps(aFirst, aSecond))
+		{
+			aOutPairs.push_back({ aFirst.myCollider, aSecond.myCollider });
+		}
+	});
+}
+
+void ColliderWorld::FindOverlappingPairs(CU::NarrowPhase& aNarrowPhase, std::vector<ColliderPair>& aOutPairs)
+{
+	if (myBroadphase == ColliderBroadphase::SweepAndPrune)
+	{
+		FindOverlappingPairs(aOutPairs);
+		return;
+	}
+
+	myCandidatePairs.clear();
+	ForEachCandidatePair([this](const Proxy& aFirst, const Proxy& aSecond)
+	{
+		myCandidatePairs.push_back({ aFirst.myCollider, aSecond.myCollider });
+	});
+	aNarrowPhase.Filter(myCandidatePairs, aOutPairs, [](const ColliderPair& aPair)
+	{
+		return aPair.myFirst->CheckCollision(*aPair.mySecond);
+	});
+}
+
+void ColliderWorld::UpdatePairs(std::vector<ColliderPair>& aOutAdded, std::vector<ColliderPair>& aOutRemoved)
+{
+	if (myBroadphase == ColliderBroadphase::SweepAndPrune)
+	{
+		// Only worlds that use UpdatePairs collect pair changes, the first call reports every pair
+		if (!mySweepAndPrune.GetTrackPairChanges())
+		{
+			mySweepAndPrune.SetTrackPairChanges(true);
+			myHasFilterChanged = true;
+		}
+		mySweepAndPrune.TakePairChanges(mySweepAdded, mySweepRemoved);
+		aOutAdded.clear();
+		aOutRemoved.clear();
+
+		// Only pairs that were reported can be removed, whatever the filter was back then
+		for (const auto& pair : mySweepRemoved)
+		{
+			if (myReportedSweepPairs.erase(MakeOrderedPair(pair.myFirst, pair.mySecond)) != 0)
+			{
+				aOutRemoved.push_back({ pair.myFirst, pair.mySecond });
+			}
+		}
+
+		if (!myHasFilterChanged)
+		{
+			for (const auto& pair : mySweepAdded)
+			{
+				if (Accepts(*pair.myFirst, *pair.mySecond))
+				{
+					myReportedSweepPairs.insert(MakeOrderedPair(pair.myFirst, pair.mySecond));
+					aOutAdded.push_back({ pair.myFirst, pair.mySecond });
+				}
+			}
+			return;
+		}
+
+		// The filter changed, every reported pair still overlaps so check them against the new filter,
+		// then look for overlapping pairs the new filter lets through
+		myHasFilterChanged = false;
+		for (auto it = myReportedSweepPairs.begin(); it != myReportedSweepPairs.end();)
+		{
+			if (ShouldCollide(*it->myFirst, *it->mySecond))
+			{
+				++it;
+				continue;
+			}
+			aOutRemoved.push_back(*it);
+			it = myReportedSweepPairs.erase(it);
+		}
+		mySweepAndPrune.ForEachPair([this, &aOutAdded](AABBCollider* aFirst, AABBCollider* aSecond)
+		{
+			if (Accepts(*aFirst, *aSecond) && myReportedSweepPairs.insert(MakeOrderedPair(aFirst, aSecond)).second)
+			{
+				aOutAdded.push_back({ aFirst, aSecond });
+			}
+		});
+		return;
+	}
+
+	// The grid has no memory of last frame's pairs, diff the sorted pair lists instead
+	FindOverlappingPairs(myCurrentPairs);
+	for (ColliderPair& pair : myCurrentPairs)
+	{
+		pair = MakeOrderedPair(pair.myFirst, pair.mySecond);
+	}
+	std::sort(myCurrentPairs.begin(), myCurrentPairs.end(), &IsLess);
+
+	aOutAdded.clear();
+	aOutRemoved.clear();
+	std::set_difference(myCurrentPairs.begin(), myCurrentPairs.end(), myLastPairs.begin(), myLastPairs.end(), std::back_inserter(aOutAdded), &IsLess);
+	std::set_difference(myLastPairs.begin(), myLastPairs.end(), myCurrentPairs.begin(), myCurrentPairs.end(), std::back_inserter(aOutRemoved), &IsLess);
+	myLastPairs.swap(myCurrentPairs);
+}
+
+void ColliderWorld::UpdateContacts(CU::ContactPairCache<AABBCollider*>& aContacts)
+{
+	aContacts.BeginFrame();
+	if (myBroadphase == ColliderBroadphase::SweepAndPrune)
+	{
+		mySweepAndPrune.ForEachPair([this, &aContacts](AABBCollider* aFirst, AABBCollider* aSecond)
+		{
+			if (Accepts(*aFirst, *aSecond))
+			{
+				aContacts.Add(aFirst, aSecond);
+			}
+		});
+	}
+	else
+	{
+		FindOverlappingPairs(myCurrentPairs);
+		for (const ColliderPair& pair : myCurrentPairs)
+		{
+			aContacts.Add(pair.myFirst, pair.mySecond);
+		}
+	}
+	aContacts.EndFrame();
+}
+
+void ColliderWorld::Query(const Tga::Vector2f& aMin, const Tga::Vector2f& aMax, std::vector<AABBCollider*>& aOutColliders, uint32_t aLayerMask) const
+{
+	aOutColliders.clear();
+
+	if (myBroadphase == ColliderBroadphase::SweepAndPrune)
+	{
+		const float min[2] = { aMin.x, aMin.y };
+		const float max[2] = { aMax.x, aMax.y };
+		mySweepAndPrune.QueryOverlap(min, max, [&aOutColliders, aLayerMask](AABBCollider* aCollider)
+		{
+			if ((aLayerMask >> aCollider->myLayer) & 1)
+			{
+				aOutColliders.push_back(aCollider);
+			}
+			return true;
+		});
+		return;
+	}
+
+	Proxy box;
+	box.myMin = aMin;
+	box.myMax = aMax;
+	const CellRange cells = GetCellRange(aMin, aMax);
+
+	// Walking the cells of a huge box costs more than testing every collider
+	if (IsOversized(cells, aMin, aMax))
+	{
+		for (const Proxy& proxy : myProxies)
+		{
+			if (proxy.myCollider && ((aLayerMask >> proxy.myLayer) & 1) && Overlaps(proxy, box))
+			{
+				aOutColliders.push_back(proxy.myCollider);
+			}
+		}
+		return;
+	}
+
+	for (uint32_t index : myOversizedProxies)
+	{
+		const Proxy& proxy = myProxies[index];
+		if (((aLayerMask >> proxy.myLayer) & 1) && Overlaps(proxy, box))
+		{
+			aOutColliders.push_back(proxy.myCollider);
+		}
+	}
+
+	const uint32_t query = ++myQueryCounter;
+	for (int y = cells.myMinY; y <= cells.myMaxY; ++y)
+	{
+		for (int x = cells.myMinX; x <= cells.myMaxX; ++x)
+		{
+			auto it = myCells.find(GetCellKey(x, y));
+			if (it == myCells.end())
+			{
+				continue;
+			}
+
+			for (uint32_t index : it->second)
+			{
+				const Proxy& proxy = myProxies[index];
+				if (proxy.myLastQuery == query)
+				{
+					continue;
+				}
+				proxy.myLastQuery = query;
+
+				if (((aLayerMask >> proxy.myLayer) & 1) && Overlaps(proxy, box))
+				{
+					aOutColliders.push_back(proxy.myCollider);
+				}
+			}
+		}
+	}
+}
+
+void ColliderWorld::Query(const AABBCollider& aCollider, std::vector<AABBCollider*>& aOutColliders) const
+{
+	Query(aCollider.GetMin(), aCollider.GetMax(), aOutColliders);
+	aOutColliders.erase(std::remove_if(aOutColliders.begin(), aOutColliders.end(), [this, &aCollider](AABBCollider* aOther)
+	{
+		return aOther == &aCollider || !Accepts(aCollider, *aOther);
+	}), aOutColliders.end());
+}
+
+void ColliderWorld::SetLayersCollide(uint32_t aFirstLayer, uint32_t aSecondLayer, bool aShouldCollide)
+{
+	assert(aFirstLayer < ourLayerCount && aSecondLayer < ourLayerCount && "Collider layers go from 0 to 31");
+	if (aShouldCollide)
+	{
+		myLayerMatrix[aFirstLayer] |= 1u << aSecondLayer;
+		myLayerMatrix[aSecondLayer] |= 1u << aFirstLayer;
+	}
+	else
+	{
+		myLayerMatrix[aFirstLayer] &= ~(1u << aSecondLayer);
+		myLayerMatrix[aSecondLayer] &= ~(1u << aFirstLayer);
+	}
+	myHasFilterChanged = true;
+}
+
+bool ColliderWorld::DoLayersCollide(uint32_t aFirstLayer, uint32_t aSecondLayer) const
+{
+	return ((myLayerMatrix[aFirstLayer] >> aSecondLayer) & 1) != 0;
+}
+
+bool ColliderWorld::ShouldCollide(const AABBCollider& aFirst, const AABBCollider& aSecond) const
+{
+	return PassesFilter(aFirst.myLayer, aFirst.myCollisionMask, aSecond.myLayer, aSecond.myCollisionMask);
+}
+
+void ColliderWorld::ResetLayerStats()
+{
+	std::fill(std::begin(myLayerStats), std::end(myLayerStats), ColliderLayerStats());
+}
+
+void ColliderWorld::SetCellSize(float aCellSize)
+{
+	myCellSize = aCellSize;
+	myInverseCellSize = 1.0f / aCellSize;
+	if (myBroadphase != ColliderBroadphase::SpatialHash)
+	{
+		return;
+	}
+
+	myCells.clear();
+	myOversizedProxies.clear();
+	for (uint32_t index = 0; index < myProxies.size(); ++index)
+	{
+		Proxy& proxy = myProxies[index];
+		if (proxy.myCollider)
+		{
+			proxy.myCells = GetCellRange(proxy.myMin, proxy.myMax);
+			InsertIntoCells(index);
+		}
+	}
+}
+
+ColliderWorld::CellRange ColliderWorld::GetCellRange(const Tga::Vector2f& aMin, const Tga::Vector2f& aMax) const
+{
+	CellRange range;
+	range.myMinX = GetCell(aMin.x);
+	range.myMinY = GetCell(aMin.y);
+	range.myMaxX = GetCell(aMax.x);
+	range.myMaxY = GetCell(aMax.y);
+	return range;
+}
+
+int ColliderWorld::GetCell(float aValue) const
+{
+	// Written so NaN fails the first test
+	const float cell = std::floor(aValue * myInverseCellSize);
+	if (!(cell > static_cast<float>(-ourCellLimit)))
+	{
+		return -ourCellLimit;
+	}
+	if (cell > static_cast<float>(ourCellLimit))
+	{
+		return ourCellLimit;
+	}
+	return static_cast<int>(cell);
+}
+
+void ColliderWorld::InsertIntoCells(uint32_t aProxyIndex)
+{
+	Proxy& proxy = myProxies[aProxyIndex];
+	proxy.myIsOversized = IsOversized(proxy.myCells, proxy.myMin, proxy.myMax);
+	if (proxy.myIsOversized)
+	{
+		myOversizedProxies.push_back(aProxyIndex);
+		return;
+	}
+
+	const CellRange& cells = proxy.myCells;
+	for (int y = cells.myMinY; y <= cells.myMaxY; ++y)
+	{
+		for (int x = cells.myMinX; x <= cells.myMaxX; ++x)
+		{
+			myCells[GetCellKey(x, y)].push_back(aProxyIndex);
+		}
+	}
+}
+
+void ColliderWorld::RemoveFromCells(uint32_t aProxyIndex)
+{
+	if (myProxies[aProxyIndex].myIsOversized)
+	{
+		auto index = std::find(myOversizedProxies.begin(), myOversizedProxies.end(), aProxyIndex);
+		*index = myOversizedProxies.back();
+		myOversizedProxies.pop_back();
+		myProxies[aProxyIndex].myIsOversized = false;
+		return;
+	}
+
+	const CellRange& cells = myProxies[aProxyIndex].myCells;
+	for (int y = cells.myMinY; y <= cells.myMaxY; ++y)
+	{
+		for (int x = cells.myMinX; x <= cells.myMaxX; ++x)
+		{
+			auto it = myCells.find(GetCellKey(x, y));
+			if (it == myCells.end())
+			{
+				continue;
+			}
+
+			// Order inside a cell does not matter, swap with the last one
+			std::vector<uint32_t>& indices = it->second;
+			auto index = std::find(indices.begin(), indices.end(), aProxyIndex);
+			if (index != indices.end())
+			{
+				*index = indices.back();
+				indices.pop_back();
+			}
+			if (indices.empty())
+			{
+				myCells.erase(it);
+			}
+		}
+	}
+}
+
+bool ColliderWorld::Accepts(const Proxy& aFirst, const Proxy& aSecond) const
+{
+	return Accepts(aFirst.myLayer, aFirst.myCollisionMask, aSecond.myLayer, aSecond.myCollisionMask);
+}
+
+bool ColliderWorld::Accepts(const AABBCollider& aFirst, const AABBCollider& aSecond) const
+{
+	return Accepts(aFirst.myLayer, aFirst.myCollisionMask, aSecond.myLayer, aSecond.myCollisionMask);
+}
+
+bool ColliderWorld::Accepts(uint32_t aFirstLayer, uint32_t aFirstMask, uint32_t aSecondLayer, uint32_t aSecondMask) const
+{
+	const bool isAccepted = PassesFilter(aFirstLayer, aFirstMask, aSecondLayer, aSecondMask);
+
+	// A pair within one layer counts once for it
+	++myLayerStats[aFirstLayer].myPairsConsidered;
+	myLayerStats[aFirstLayer].myPairsRejected += isAccepted ? 0 : 1;
+	if (aSecondLayer != aFirstLayer)
+	{
+		++myLayerStats[aSecondLayer].myPairsConsidered;
+		myLayerStats[aSecondLayer].myPairsRejected += isAccepted ? 0 : 1;
+	}
+	return isAccepted;
+}
+
+bool ColliderWorld::PassesFilter(uint32_t aFirstLayer, uint32_t aFirstMask, uint32_t aSecondLayer, uint32_t aSecondMask) const
+{
+	return ((aFirstMask >> aSecondLayer) & 1) != 0
+		&& ((aSecondMask >> aFirstLayer) & 1) != 0
+		&& ((myLayerMatrix[aFirstLayer] >> aSecondLayer) & 1) != 0;
+}
+
+bool ColliderWorld::IsOversized(const CellRange& aCells, const Tga::Vector2f& aMin, const Tga::Vector2f& aMax)
+{
+	if (!std::isfinite(aMin.x) || !std::isfinite(aMin.y) || !std::isfinite(aMax.x) || !std::isfinite(aMax.y))
+	{
+		return true;
+	}
+
+	// An inverted box covers no cells
+	const int64_t width = static_cast<int64_t>(aCells.myMaxX) - aCells.myMinX + 1;
+	const int64_t height = static_cast<int64_t>(aCells.myMaxY) - aCells.myMinY + 1;
+	return width > 0 && height > 0 && width * height > ourMaxCellsPerCollider;
+}
+
+uint64_t ColliderWorld::GetCellKey(int aX, int aY)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(aX)) << 32) | static_cast<uint32_t>(aY);
+}
+
+bool ColliderWorld::Overlaps(const Proxy& aFirst, const Proxy& aSecond)
+{
+	// Same inclusive test as AABBCollider::CheckCollision
+	return aFirst.myMax.x >= aSecond.myMin.x && aFirst.myMin.x <= aSecond.myMax.x
+		&& aFirst.myMax.y >= aSecond.myMin.y && aFirst.myMin.y <= aSecond.myMax.y;
+}
+
+bool ColliderWorld::IsLess(const ColliderPair& aFirst, const ColliderPair& aSecond)
+{
+	const std::less<AABBCollider*> less;
+	if (aFirst.myFirst != aSecond.myFirst)
+	{
+		return less(aFirst.myFirst, aSecond.myFirst);
+	}
+	return less(aFirst.mySecond, aSecond.mySecond);
+}
+
+ColliderPair ColliderWorld::MakeOrderedPair(AABBCollider* aFirst, AABBCollider* aSecond)
+{
+	if (std::less<AABBCollider*>()(aSecond, aFirst))
+	{
+		return { aSecond, aFirst };
+	}
+	return { aFirst, aSecond };
+}
+
+size_t ColliderWorld::ColliderPairHash::operator()(const ColliderPair& aPair) const
+{
+	const size_t first = std::hash<AABBCollider*>()(aPair.myFirst);
+	return first ^ (std::hash<AABBCollider*>()(aPair.mySecond) + 0x9E3779B9u + (first << 6) + (first >> 2));
+}
+
+bool ColliderWorld::ColliderPairEqual::operator()(const ColliderPair& aFirst, const ColliderPair& aSecond) const
+{
+	return aFirst.myFirst == aSecond.myFirst && aFirst.mySecond == aSecond.mySecond;
+}
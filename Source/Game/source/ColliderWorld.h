@@ -0,0 +1,190 @@
+#pragma once
+#include <tge/math/vector2.h>
+#include <CommonUtilities/Collision/ContactPairCache.hpp>
+#include <CommonUtilities/Collision/NarrowPhase.hpp>
+#include <CommonUtilities/Collision/SweepAndPrune.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class AABBCollider;
+
+struct ColliderPair
+{
+	AABBCollider* myFirst;
+	AABBCollider* mySecond;
+};
+
+struct ColliderLayerStats
+{
+	// Candidate pairs with a collider on this layer that reached the layer filter, and how many it dropped
+	uint64_t myPairsConsidered = 0;
+	uint64_t myPairsRejected = 0;
+};
+
+enum class ColliderBroadphase
+{
+	// Uniform grid stored as a spatial hash. Pick a cell size around the size of the common collider,
+	// a collider covering many cells is in all of them. Colliders covering more than
+	// ColliderWorld::ourMaxCellsPerCollider cells, or with bounds that are not finite, are kept out of
+	// the grid and tested against every other collider instead.
+	SpatialHash,
+	// Sorted endpoints on both axes, cheap when most colliders move a little each frame.
+	// Queries walk the x axis up to the query box, pairs are kept up to date on every move.
+	SweepAndPrune,
+};
+
+// Broadphase for AABBColliders. Added colliders update the broadphase themselves from SetPosition and
+// SetRect, so only colliders that moved cost anything. Colliders are not owned, a collider that is
+// destroyed leaves the world by itself.
+// Candidate pairs go through a layer filter before the box test, see AABBCollider::SetLayer.
+class ColliderWorld
+{
+public:
+	static constexpr uint32_t ourLayerCount = 32;
+	static constexpr int64_t ourMaxCellsPerCollider = 256;
+
+	explicit ColliderWorld(float aCellSize = 64.0f, ColliderBroadphase aBroadphase = ColliderBroadphase::SpatialHash);
+	explicit ColliderWorld(ColliderBroadphase aBroadphase);
+	ColliderWorld(const ColliderWorld& aColliderWorld) = delete;
+	ColliderWorld& operator=(const ColliderWorld& aColliderWorld) = delete;
+	~ColliderWorld();
+
+	// A collider can be in one world at a time, adding it again moves it here
+	void Add(AABBCollider& aCollider);
+	void Remove(AABBCollider& aCollider);
+
+	// Every pair of colliders whose boxes overlap, each pair once. Replaces the content of aOutPairs.
+	void FindOverlappingPairs(std::vector<ColliderPair>& aOutPairs) const;
+
+	// Same pairs, in the same order, with the box tests run on aNarrowPhase's thread pool. Only the
+	// spatial hash has box tests left to run, sweep and prune pairs already overlap.
+	void FindOverlappingPairs(CU::NarrowPhase& aNarrowPhase, std::vector<ColliderPair>& aOutPairs);
+
+	// Pairs that started and stopped overlapping since the last call, replaces the content of both vectors.
+	// Colliders in removed pairs may have been destroyed since, only compare those pointers.
+	void UpdatePairs(std::vector<ColliderPair>& aOutAdded, std::vector<ColliderPair>& aOutRemoved);
+
+	// Runs one frame of aContacts with every overlapping pair, afterwards its begin, persist and end
+	// arrays hold this frame's events. Several caches can follow the same world.
+	void UpdateContacts(CU::ContactPairCache<AABBCollider*>& aContacts);
+
+	// Colliders on one of the layers in aLayerMask overlapping the box, each once. Replaces the content of aOutColliders.
+	void Query(const Tga::Vector2f& aMin, const Tga::Vector2f& aMax, std::vector<AABBCollider*>& aOutColliders, uint32_t aLayerMask = ~0u) const;
+
+	// Colliders overlapping aCollider that pass the layer filter with it, not including aCollider itself
+	void Query(const AABBCollider& aCollider, std::vector<AABBCollider*>& aOutColliders) const;
+
+	// Layer matrix, every pair of layers collides until told otherwise. Takes effect on the next pair update.
+	void SetLayersCollide(uint32_t aFirstLayer, uint32_t aSecondLayer, bool aShouldCollide);
+	bool DoLayersCollide(uint32_t aFirstLayer, uint32_t aSecondLayer) const;
+
+	// Whether the pair passes the layer filter, the same test the broadphase runs
+	bool ShouldCollide(const AABBCollider& aFirst, const AABBCollider& aSecond) const;
+
+	// Counted by every FindOverlappingPairs, UpdatePairs, UpdateContacts and collider Query
+	const ColliderLayerStats& GetLayerStats(uint32_t aLayer) const { return myLayerStats[aLayer]; }
+	void ResetLayerStats();
+
+	// Re-buckets every collider, only used by the spatial hash
+	void SetCellSize(float aCellSize);
+	float GetCellSize() const { return myCellSize; }
+
+	ColliderBroadphase GetBroadphase() const { return myBroadphase; }
+
+	size_t size() const { return myProxies.size() - myFreeProxies.size(); }
+
+private:
+	friend class AABBCollider;
+
+	// Far beyond any cell a finite collider of sane size reaches, keeps the float to int conversion defined
+	static constexpr int ourCellLimit = 1 << 20;
+
+	struct CellRange
+	{
+		int myMinX;
+		int myMinY;
+		int myMaxX;
+		int myMaxY;
+
+		bool operator==(const CellRange& aOther) const;
+	};
+
+	struct Proxy
+	{
+		AABBCollider* myCollider = nullptr;
+		Tga::Vector2f myMin;
+		Tga::Vector2f myMax;
+		CellRange myCells = {};
+		// Too large for the grid, in myOversizedProxies instead of myCells
+		bool myIsOversized = false;
+		int mySweepProxy = -1;
+		uint32_t myLayer = 0;
+		uint32_t myCollisionMask = ~0u;
+		// Query stamp, keeps a collider spanning several cells from being returned more than once
+		mutable uint32_t myLastQuery = 0;
+	};
+
+	struct ColliderPairHash
+	{
+		size_t operator()(const ColliderPair& aPair) const;
+	};
+
+	struct ColliderPairEqual
+	{
+		bool operator()(const ColliderPair& aFirst, const ColliderPair& aSecond) const;
+	};
+
+	// Called by the collider when it moved or changed size
+	void Update(AABBCollider& aCollider);
+	// Called by the collider when its layer or collision mask changed
+	void UpdateFilter(AABBCollider& aCollider);
+
+	// Layer filter for a candidate pair, updates the layer stats
+	bool Accepts(const Proxy& aFirst, const Proxy& aSecond) const;
+	bool Accepts(const AABBCollider& aFirst, const AABBCollider& aSecond) const;
+	bool Accepts(uint32_t aFirstLayer, uint32_t aFirstMask, uint32_t aSecondLayer, uint32_t aSecondMask) const;
+	bool PassesFilter(uint32_t aFirstLayer, uint32_t aFirstMask, uint32_t aSecondLayer, uint32_t aSecondMask) const;
+
+	// aCallback(const Proxy&, const Proxy&) once for every pair sharing a cell and passing the layer filter
+	template<class Callback>
+	void ForEachCandidatePair(Callback&& aCallback) const;
+
+	// Clamped to ourCellLimit on both axes, so any bounds give a valid range
+	CellRange GetCellRange(const Tga::Vector2f& aMin, const Tga::Vector2f& aMax) const;
+	int GetCell(float aValue) const;
+	// Inserts into the cells of myCells, or into myOversizedProxies when the range is too large
+	void InsertIntoCells(uint32_t aProxyIndex);
+	void RemoveFromCells(uint32_t aProxyIndex);
+
+	static bool IsOversized(const CellRange& aCells, const Tga::Vector2f& aMin, const Tga::Vector2f& aMax);
+
+	static uint64_t GetCellKey(int aX, int aY);
+	static bool Overlaps(const Proxy& aFirst, const Proxy& aSecond);
+	static bool IsLess(const ColliderPair& aFirst, const ColliderPair& aSecond);
+	static ColliderPair MakeOrderedPair(AABBCollider* aFirst, AABBCollider* aSecond);
+
+	ColliderBroadphase myBroadphase;
+	std::unordered_map<uint64_t, std::vector<uint32_t>> myCells;
+	std::vector<uint32_t> myOversizedProxies;
+	CU::SweepAndPrune<float, 2, AABBCollider*> mySweepAndPrune;
+	std::vector<CU::SweepAndPrune<float, 2, AABBCollider*>::Pair> mySweepAdded;
+	std::vector<CU::SweepAndPrune<float, 2, AABBCollider*>::Pair> mySweepRemoved;
+	// Sweep and prune pairs UpdatePairs reported as added and not yet as removed, so a filter change can
+	// be turned into pair changes without going through every pair each frame
+	std::unordered_set<ColliderPair, ColliderPairHash, ColliderPairEqual> myReportedSweepPairs;
+	bool myHasFilterChanged = false;
+	// Spatial hash pairs at the last UpdatePairs, sorted, to diff the next ones against
+	std::vector<ColliderPair> myLastPairs;
+	std::vector<ColliderPair> myCurrentPairs;
+	std::vector<ColliderPair> myCandidatePairs;
+	std::vector<Proxy> myProxies;
+	std::vector<uint32_t> myFreeProxies;
+	uint32_t myLayerMatrix[ourLayerCount];
+	mutable ColliderLayerStats myLayerStats[ourLayerCount];
+	float myCellSize;
+	float myInverseCellSize;
+	mutable uint32_t myQueryCounter = 0;
+};
@@ -1 +1,232 @@
+#include "stdafx.h"
+
 #include "CustomRenderer.h"
+
+#include <tge/drawers/SpriteDrawer.h>
+
+#include <algorithm>
+#include <array>
+
+namespace
+{
+	// Sort key bits, most significant first. Shader and texture IDs wrap past their width,
+	// which only costs batches, never correctness, because Flush compares the real state.
+	constexpr uint64_t ourGroupBits = 8;
+	constexpr uint64_t ourLayerBits = 16;
+	constexpr uint64_t ourShaderBits = 10;
+	constexpr uint64_t ourTextureBits = 20;
+	constexpr uint64_t ourBlendBits = 4;
+	constexpr uint64_t ourSamplerBits = 6;
+	static_assert(ourGroupBits + ourLayerBits + ourShaderBits + ourTextureBits + ourBlendBits + ourSamplerBits == 64, "Sort key has to fill 64 bits");
+
+	constexpr uint64_t Mask(uint64_t aBits)
+	{
+		return (uint64_t(1) << aBits) - 1;
+	}
+}
+
+CustomRenderer::CustomRenderer(unsigned int aFrameLatency)
+	: myFrameLatency(std::min(aFrameLatency, ourMaxFrameLatency))
+	, myRenderThread(1)
+{
+}
+
+CustomRenderer::~CustomRenderer()
+{
+	// Packets in flight reference myPackets, let the render thread finish with them
+	for (FramePacket& packet : myPackets)
+	{
+		if (packet.myIsPrepared.valid())
+		{
+			packet.myIsPrepared.wait();
+		}
+	}
+}
+
+void CustomRenderer::Submit(const RenderCommand& aCommand)
+{
+	FramePacket& packet = myPackets[GetRecordingIndex()];
+	packet.myEntries.push_back({ MakeSortKey(aCommand), static_cast<uint32_t>(packet.myCommands.size()) });
+	packet.myCommands.push_back(aCommand);
+}
+
+void CustomRenderer::Submit(const Tga::SpriteSharedData& aSharedData, const Tga::Sprite2DInstanceData& aInstance, uint16_t aLayer)
+{
+	RenderCommand command;
+	command.Instance = aInstance;
+	command.Data = aSharedData;
+	command.Layer = aLayer;
+	Submit(command);
+}
+
+void CustomRenderer::BeginGroup()
+{
+	if (GetCommandCount() > 0)
+	{
+		++myGroup;
+	}
+}
+
+void CustomRenderer::Flush(Tga::SpriteDrawer& aSpriteDrawer)
+{
+	FramePacket& recordedPacket = myPackets[GetRecordingIndex()];
+	myShaderIDs.clear();
+	myTextureIDs.clear();
+	myGroup = 0;
+
+	if (myFrameLatency == 0)
+	{
+		Prepare(recordedPacket);
+		Draw(recordedPacket, aSpriteDrawer);
+		return;
+	}
+
+	recordedPacket.myIsPrepared = myRenderThread.Enqueue([&recordedPacket]() { Prepare(recordedPacket); });
+	++myInFlightCount;
+
+	while (myInFlightCount > myFrameLatency)
+	{
+		FramePacket& oldestPacket = myPackets[myOldestIndex];
+		oldestPacket.myIsPrepared.get();
+		Draw(oldestPacket, aSpriteDrawer);
+
+		myOldestIndex = (myOldestIndex + 1) % myPackets.size();
+		--myInFlightCount;
+	}
+}
+
+void CustomRenderer::Draw(FramePacket& aPacket, Tga::SpriteDrawer& aSpriteDrawer)
+{
+	for (const Batch& batch : aPacket.myBatches)
+	{
+		Tga::SpriteBatchScope scope = aSpriteDrawer.BeginBatch(batch.myData);
+		scope.Draw(aPacket.myInstances.data() + batch.myFirstInstance, batch.myInstanceCount);
+	}
+	myLastBatchCount = aPacket.myBatches.size();
+
+	aPacket.myCommands.clear();
+	aPacket.myEntries.clear();
+	aPacket.myBatches.clear();
+	aPacket.myInstances.clear();
+}
+
+void CustomRenderer::Prepare(FramePacket& aPacket)
+{
+	SortEntries(aPacket);
+
+	aPacket.myInstances.resize(aPacket.myEntries.size());
+	size_t instanceCount = 0;
+	const Tga::SpriteSharedData* batchData = nullptr;
+
+	for (const SortEntry& entry : aPacket.myEntries)
+	{
+		const RenderCommand& command = aPacket.myCommands[entry.myIndex];
+		if (!Tga::SpriteDrawer::BuildInstanceData(command.Instance, aPacket.myInstances[instanceCount]))
+		{
+			continue;
+		}
+
+		if (!batchData || !HasSameRenderState(*batchData, command.Data))
+		{
+			aPacket.myBatches.push_back({ command.Data, instanceCount, 0 });
+			batchData = &command.Data;
+		}
+		++aPacket.myBatches.back().myInstanceCount;
+		++instanceCount;
+	}
+	aPacket.myInstances.resize(instanceCount);
+}
+
+uint64_t CustomRenderer::MakeSortKey(const RenderCommand& aCommand)
+{
+	const Tga::SpriteSharedData& data = aCommand.Data;
+	const uint64_t shader = GetDenseID(myShaderIDs, data.myCustomShader);
+	const uint64_t texture = GetDenseID(myTextureIDs, data.myTexture);
+	const uint64_t blend = static_cast<uint64_t>(data.myBlendState);
+	const uint64_t sampler = static_cast<uint64_t>(data.mySamplerFilter) * static_cast<uint64_t>(Tga::SamplerAddressMode::Count) + static_cast<uint64_t>(data.mySamplerAddressMode);
+
+	uint64_t key = myGroup & Mask(ourGroupBits);
+	key = (key << ourLayerBits) | (aCommand.Layer & Mask(ourLayerBits));
+	key = (key << ourShaderBits) | (shader & Mask(ourShaderBits));
+	key = (key << ourTextureBits) | (texture & Mask(ourTextureBits));
+	key = (key << ourBlendBits) | (blend & Mask(ourBlendBits));
+	key = (key << ourSamplerBits) | (sampler & Mask(ourSamplerBits));
+	return key;
+}
+
+void CustomRenderer::SortEntries(FramePacket& aPacket)
+{
+	// LSD radix sort, 8 bits per pass. It is stable, so equal keys keep their submission order.
+	constexpr size_t passCount = sizeof(uint64_t);
+	constexpr size_t bucketCount = 256;
+
+	std::array<std::array<size_t, bucketCount>, passCount> histograms = {};
+	for (const SortEntry& entry : aPacket.myEntries)
+	{
+		for (size_t pass = 0; pass < passCount; ++pass)
+		{
+			++histograms[pass][(entry.myKey >> (pass * 8)) & 0xFF];
+		}
+	}
+
+	aPacket.mySortBuffer.resize(aPacket.myEntries.size());
+	for (size_t pass = 0; pass < passCount; ++pass)
+	{
+		std::array<size_t, bucketCount>& histogram = histograms[pass];
+
+		// Every key has the same byte here, this pass would not move anything
+		const uint64_t firstByte = aPacket.myEntries.empty() ? 0 : (aPacket.myEntries[0].myKey >> (pass * 8)) & 0xFF;
+		if (histogram[firstByte] == aPacket.myEntries.size())
+		{
+			continue;
+		}
+
+		size_t offset = 0;
+		for (size_t& count : histogram)
+		{
+			const size_t bucketSize = count;
+			count = offset;
+			offset += bucketSize;
+		}
+
+		for (const SortEntry& entry : aPacket.myEntries)
+		{
+			aPacket.mySortBuffer[histogram[(entry.myKey >> (pass * 8)) & 0xFF]++] = entry;
+		}
+		aPacket.myEntries.swap(aPacket.mySortBuffer);
+	}
+}
+
+uint32_t CustomRenderer::GetDenseID(std::unordered_map<const void*, uint32_t>& aIDs, const void* aPointer)
+{
+	auto it = aIDs.find(aPointer);
+	if (it != aIDs.end())
+	{
+		return it->second;
+	}
+
+	const uint32_t id = static_cast<uint32_t>(aIDs.size());
+	aIDs.emplace(aPointer, id);
+	return id;
+}
+
+bool CustomRenderer::HasSameRenderState(const Tga::SpriteSharedData& aFirst, const Tga::SpriteSharedData& aSecond)
+{
+	if (aFirst.myTexture != aSecond.myTexture
+		|| aFirst.myCustomShader != aSecond.myCustomShader
+		|| aFirst.myBlendState != aSecond.myBlendState
+		|| aFirst.mySamplerFilter != aSecond.mySamplerFilter
+		|| aFirst.mySamplerAddressMode != aSecond.mySamplerAddressMode)
+	{
+		return false;
+	}
+
+	for (int map = 0; map < Tga::MAP_MAX; ++map)
+	{
+		if (aFirst.myMaps[map] != aSecond.myMaps[map])
+		{
+			return false;
+		}
+	}
+	return true;
+}
@@ -1,8 +1,103 @@
 #pragma once
+#include "RenderCommand.h"
 
-// In progress system ignore
+#include <CommonUtilities/Common/ThreadPool.h>
+
+#include <array>
+#include <cstdint>
+#include <future>
+#include <unordered_map>
+#include <vector>
+
+namespace Tga
+{
+	class SpriteDrawer;
+}
+
+// Per frame sprite queue. Sprites are submitted during Render and Flush draws them sorted by
+// (group, layer, shader, texture, blend state), one SpriteBatchScope per run of equal render state.
+// Everything submitted after BeginGroup is drawn over everything submitted before it, up to 256 groups
+// per frame, and inside a group lower layers are drawn first. Sprites in the same group and layer only
+// keep their submission order if they share all render state, so give sprites that overlap in a fixed
+// order their own layers.
+//
+// Each frame is recorded into a frame packet. Flush hands it to the render thread, which sorts it and
+// builds the shader instance data while the next frame updates, and the main thread draws it once it is
+// aFrameLatency frames old. The device context stays on the main thread, so only the CPU side moves.
+// Textures in a packet are drawn up to aFrameLatency frames after they were submitted.
 class CustomRenderer
 {
-	
-};
+public:
+	static constexpr unsigned int ourMaxFrameLatency = 2;
+
+	// aFrameLatency 0 sorts and draws every frame inside its own Flush
+	explicit CustomRenderer(unsigned int aFrameLatency = 1);
+	CustomRenderer(const CustomRenderer& aCustomRenderer) = delete;
+	CustomRenderer& operator=(const CustomRenderer& aCustomRenderer) = delete;
+	~CustomRenderer();
+
+	void Submit(const RenderCommand& aCommand);
+	void Submit(const Tga::SpriteSharedData& aSharedData, const Tga::Sprite2DInstanceData& aInstance, uint16_t aLayer = 0);
+
+	// The StateStack starts a group before each state's Render, so states stay on top of the ones below them
+	void BeginGroup();
+
+	// Ends the frame being recorded and draws the oldest frame that is due
+	void Flush(Tga::SpriteDrawer& aSpriteDrawer);
+
+	// Commands submitted to the frame being recorded
+	size_t GetCommandCount() const { return myPackets[GetRecordingIndex()].myCommands.size(); }
+
+	// Batches, and so draw calls, the last drawn frame needed
+	size_t GetLastBatchCount() const { return myLastBatchCount; }
 
+private:
+	struct SortEntry
+	{
+		uint64_t myKey;
+		uint32_t myIndex;
+	};
+
+	struct Batch
+	{
+		Tga::SpriteSharedData myData;
+		size_t myFirstInstance;
+		size_t myInstanceCount;
+	};
+
+	struct FramePacket
+	{
+		// Filled while recording
+		std::vector<RenderCommand> myCommands;
+		std::vector<SortEntry> myEntries;
+
+		// Filled by Prepare on the render thread
+		std::vector<SortEntry> mySortBuffer;
+		std::vector<Batch> myBatches;
+		std::vector<Tga::SpriteShaderInstanceData> myInstances;
+		std::future<void> myIsPrepared;
+	};
+
+	size_t GetRecordingIndex() const { return (myOldestIndex + myInFlightCount) % myPackets.size(); }
+	uint64_t MakeSortKey(const RenderCommand& aCommand);
+	void Draw(FramePacket& aPacket, Tga::SpriteDrawer& aSpriteDrawer);
+
+	static void Prepare(FramePacket& aPacket);
+	static void SortEntries(FramePacket& aPacket);
+	static uint32_t GetDenseID(std::unordered_map<const void*, uint32_t>& aIDs, const void* aPointer);
+	static bool HasSameRenderState(const Tga::SpriteSharedData& aFirst, const Tga::SpriteSharedData& aSecond);
+
+	std::array<FramePacket, ourMaxFrameLatency + 1> myPackets;
+	size_t myOldestIndex = 0;
+	size_t myInFlightCount = 0;
+	unsigned int myFrameLatency;
+
+	// Shaders and textures numbered in order of first use this frame, keeps the sort key small
+	std::unordered_map<const void*, uint32_t> myShaderIDs;
+	std::unordered_map<const void*, uint32_t> myTextureIDs;
+
+	uint16_t myGroup = 0;
+	size_t myLastBatchCount = 0;
+
+	CU::ThreadPool myRenderThread;
+};
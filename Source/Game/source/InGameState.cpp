@@ -2,6 +2,8 @@
 
 #include "InGameState.h"
 #include "StateStackProxy.h"
+#include "StateEvents.h"
+#include "CustomRenderer.h"
 
 #include <tge/texture/TextureManager.h>
 #include <tge/drawers/SpriteDrawer.h>
@@ -13,7 +15,8 @@ void InGameState::Init()
 {
 	auto& engine = *Tga::Engine::GetInstance();
 
-	mySpriteSharedData.myTexture = engine.GetTextureManager().GetTexture(Tga::Settings::GetAssetW("Sprites/903580.png").c_str());
+	myTexture = engine.GetTextureManager().AcquireTexture(Tga::Settings::GetAssetW("Sprites/903580.png").c_str());
+	mySpriteSharedData.myTexture = myTexture;
 
 	mySprite.myColor = Tga::Color(1, 1, 1);
 	mySprite.myPivot = { 0.5f, 0.5f };
@@ -22,6 +25,23 @@ void InGameState::Init()
 	Tga::Vector2f myResolution = { (float)intResolution.x, (float)intResolution.y };
 	mySprite.myPosition = myResolution * 0.5f;
 	mySprite.mySize = myResolution;
+
+	myStateStackProxy.Subscribe<SettingsChangedEvent>(GetID(), [this](const SettingsChangedEvent& aEvent)
+	{
+		mySprite.myColor = Tga::Color(aEvent.myBrightness, aEvent.myBrightness, aEvent.myBrightness);
+	});
+}
+
+void InGameState::Preload()
+{
+	myTexturePreloader.Clear();
+	myTexturePreloader.AddTexture(Tga::Settings::GetAssetW("Sprites/903580.png"));
+	myTexturePreloader.ReadFiles();
+}
+
+bool InGameState::FinishPreload()
+{
+	return myTexturePreloader.UploadNext();
 }
 
 bool InGameState::Update()
@@ -39,8 +59,14 @@ bool InGameState::Update()
 	return true;
 }
 
-void InGameState::Render()
+void InGameState::Render(float /*aInterpolationAlpha*/)
 {
+	if (CustomRenderer* renderer = myStateStackProxy.GetRenderer())
+	{
+		renderer->Submit(mySpriteSharedData, mySprite);
+		return;
+	}
+
 	auto& engine = *Tga::Engine::GetInstance();
 
 	Tga::SpriteDrawer& spriteDrawer(engine.GetGraphicsEngine().GetSpriteDrawer());
@@ -53,3 +79,22 @@ void InGameState::ExitState()
 
 void InGameState::Deactivate()
 {}
+
+size_t InGameState::GetResourceFootprint() const
+{
+	if (!myTexture)
+	{
+		return 0;
+	}
+
+	// RGBA8, the GPU copy is what stays resident
+	const Tga::Vector2ui imageSize = myTexture->myImageSize;
+	return static_cast<size_t>(imageSize.x) * imageSize.y * 4;
+}
+
+void InGameState::ReleaseResources()
+{
+	Tga::Engine::GetInstance()->GetTextureManager().ReleaseTexture(myTexture);
+	myTexture = nullptr;
+	mySpriteSharedData.myTexture = nullptr;
+}
@@ -1,25 +1,44 @@
 #pragma once
 #include "State.h"
+#include "TexturePreloader.h"
 
-class InGameState :
+namespace Tga
+{
+	class Texture;
+}
+
+class InGameState final :
 	public State
 {
 public:
 	using State::State;
 
+	// Slot key for StaticStateStack
+	static constexpr StateID ourID = StateID::InGame;
+
 	// Inherited via State
 	void Init() override;
 
+	void Preload() override;
+	bool FinishPreload() override;
+
 	bool Update() override;
-	void Render() override;
+	void Render(float aInterpolationAlpha) override;
 
 	void ExitState() override;
 	void Deactivate() override;
 
+	size_t GetResourceFootprint() const override;
+	void ReleaseResources() override;
+
 	bool LetThroughRender() override { return false; }
 
 private:
 	Tga::Sprite2DInstanceData mySprite;
 	Tga::SpriteSharedData mySpriteSharedData;
+	// Typed handle to the texture in mySpriteSharedData, for its size and for releasing it
+	Tga::Texture* myTexture = nullptr;
+
+	TexturePreloader myTexturePreloader;
 };
 
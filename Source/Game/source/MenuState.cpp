@@ -2,6 +2,7 @@
 
 #include "MenuState.h"
 #include "StateStackProxy.h"
+#include "CustomRenderer.h"
 
 #include <tge/texture/TextureManager.h>
 #include <tge/drawers/SpriteDrawer.h>
@@ -13,7 +14,8 @@ void MenuState::Init()
 {
 	auto& engine = *Tga::Engine::GetInstance();
 
-	mySpriteSharedData.myTexture = engine.GetTextureManager().GetTexture(Tga::Settings::GetAssetW("Sprites/hd-main-menu.png").c_str());
+	myTexture = engine.GetTextureManager().AcquireTexture(Tga::Settings::GetAssetW("Sprites/hd-main-menu.png").c_str());
+	mySpriteSharedData.myTexture = myTexture;
 
 	
 	mySprite.myColor = Tga::Color(1, 1, 1);
@@ -23,6 +25,10 @@ void MenuState::Init()
 	Tga::Vector2f myResolution = { (float)intResolution.x, (float)intResolution.y };
 	mySprite.myPosition = myResolution * 0.5f;
 	mySprite.mySize = myResolution;
+
+	// Both are reachable from the menu, load them while the player looks at it
+	myStateStackProxy.PreloadState(StateID::InGame);
+	myStateStackProxy.PreloadState(StateID::Options);
 }
 
 bool MenuState::Update()
@@ -43,8 +49,14 @@ bool MenuState::Update()
 	return true;
 }
 
-void MenuState::Render()
+void MenuState::Render(float /*aInterpolationAlpha*/)
 {
+	if (CustomRenderer* renderer = myStateStackProxy.GetRenderer())
+	{
+		renderer->Submit(mySpriteSharedData, mySprite);
+		return;
+	}
+
 	auto& engine = *Tga::Engine::GetInstance();
 
 	Tga::SpriteDrawer& spriteDrawer(engine.GetGraphicsEngine().GetSpriteDrawer());
@@ -57,3 +69,22 @@ void MenuState::ExitState()
 
 void MenuState::Deactivate()
 {}
+
+size_t MenuState::GetResourceFootprint() const
+{
+	if (!myTexture)
+	{
+		return 0;
+	}
+
+	// RGBA8, the GPU copy is what stays resident
+	const Tga::Vector2ui imageSize = myTexture->myImageSize;
+	return static_cast<size_t>(imageSize.x) * imageSize.y * 4;
+}
+
+void MenuState::ReleaseResources()
+{
+	Tga::Engine::GetInstance()->GetTextureManager().ReleaseTexture(myTexture);
+	myTexture = nullptr;
+	mySpriteSharedData.myTexture = nullptr;
+}
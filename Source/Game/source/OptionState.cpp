@@ -2,6 +2,8 @@
 
 #include "OptionState.h"
 #include "StateStackProxy.h"
+#include "StateEvents.h"
+#include "CustomRenderer.h"
 
 #include <tge/texture/TextureManager.h>
 #include <tge/drawers/SpriteDrawer.h>
@@ -13,7 +15,8 @@ void OptionState::Init()
 {
 	auto& engine = *Tga::Engine::GetInstance();
 
-	mySpriteSharedData.myTexture = engine.GetTextureManager().GetTexture(Tga::Settings::GetAssetW("Sprites/1702050-vga_charts_2008_2_9_158193_13.png").c_str());
+	myTexture = engine.GetTextureManager().AcquireTexture(Tga::Settings::GetAssetW("Sprites/1702050-vga_charts_2008_2_9_158193_13.png").c_str());
+	mySpriteSharedData.myTexture = myTexture;
 
 	mySprite.mySize = mySpriteSharedData.myTexture->CalculateTextureSize();
 	mySprite.myColor = Tga::Color(1, 1, 1);
@@ -24,6 +27,18 @@ void OptionState::Init()
 	mySprite.myPosition = myResolution * 0.5f;
 }
 
+void OptionState::Preload()
+{
+	myTexturePreloader.Clear();
+	myTexturePreloader.AddTexture(Tga::Settings::GetAssetW("Sprites/1702050-vga_charts_2008_2_9_158193_13.png"));
+	myTexturePreloader.ReadFiles();
+}
+
+bool OptionState::FinishPreload()
+{
+	return myTexturePreloader.UploadNext();
+}
+
 bool OptionState::Update()
 {
 	if (CU::Input::GetKeyDown(CU::Keys::ESCAPE))
@@ -31,11 +46,24 @@ bool OptionState::Update()
 		return false;
 	}
 
+	const float brightnessStep = (CU::Input::GetKeyDown(CU::Keys::UP) ? 0.1f : 0.0f) - (CU::Input::GetKeyDown(CU::Keys::DOWN) ? 0.1f : 0.0f);
+	if (brightnessStep != 0.0f)
+	{
+		myBrightness = std::clamp(myBrightness + brightnessStep, 0.1f, 1.0f);
+		myStateStackProxy.PostEvent(SettingsChangedEvent{ myBrightness });
+	}
+
 	return true;
 }
 
-void OptionState::Render()
+void OptionState::Render(float /*aInterpolationAlpha*/)
 {
+	if (CustomRenderer* renderer = myStateStackProxy.GetRenderer())
+	{
+		renderer->Submit(mySpriteSharedData, mySprite);
+		return;
+	}
+
 	auto& engine = *Tga::Engine::GetInstance();
 
 	Tga::SpriteDrawer& spriteDrawer(engine.GetGraphicsEngine().GetSpriteDrawer());
@@ -48,3 +76,22 @@ void OptionState::ExitState()
 
 void OptionState::Deactivate()
 {}
+
+size_t OptionState::GetResourceFootprint() const
+{
+	if (!myTexture)
+	{
+		return 0;
+	}
+
+	// RGBA8, the GPU copy is what stays resident
+	const Tga::Vector2ui imageSize = myTexture->myImageSize;
+	return static_cast<size_t>(imageSize.x) * imageSize.y * 4;
+}
+
+void OptionState::ReleaseResources()
+{
+	Tga::Engine::GetInstance()->GetTextureManager().ReleaseTexture(myTexture);
+	myTexture = nullptr;
+	mySpriteSharedData.myTexture = nullptr;
+}
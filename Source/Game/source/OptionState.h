@@ -1,25 +1,46 @@
 #pragma once
 #include "State.h"
+#include "TexturePreloader.h"
 
-class OptionState :
+namespace Tga
+{
+	class Texture;
+}
+
+class OptionState final :
 	public State
 {
 public:
 	using State::State;
 
+	// Slot key for StaticStateStack
+	static constexpr StateID ourID = StateID::Options;
+
 	// Inherited via State
 	void Init() override;
 
+	void Preload() override;
+	bool FinishPreload() override;
+
 	bool Update() override;
-	void Render() override;
+	void Render(float aInterpolationAlpha) override;
 
 	void ExitState() override;
 	void Deactivate() override;
 
+	size_t GetResourceFootprint() const override;
+	void ReleaseResources() override;
+
 	bool LetThroughRender() override { return true; }
 	
 private:
 	Tga::Sprite2DInstanceData mySprite;
 	Tga::SpriteSharedData mySpriteSharedData;
+	// Typed handle to the texture in mySpriteSharedData, for its size and for releasing it
+	Tga::Texture* myTexture = nullptr;
+
+	TexturePreloader myTexturePreloader;
+
+	float myBrightness = 1.0f;
 };
 
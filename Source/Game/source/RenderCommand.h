@@ -1,8 +1,12 @@
 #pragma once
 #include "stdafx.h"
 
+#include <cstdint>
+
 struct RenderCommand
 {
 	Tga::Sprite2DInstanceData Instance;
 	Tga::SpriteSharedData Data;
-};
\ No newline at end of file
+	// Lower layers are drawn first, see CustomRenderer
+	uint16_t Layer = 0;
+};
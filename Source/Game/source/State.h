@@ -1,7 +1,17 @@
 #pragma once
+#include "StateEnum.h"
+#include <cstddef>
 
 class StateStackProxy;
 
+namespace CU
+{
+	class LinearAllocator;
+}
+
+template<class... States>
+class StaticStateStack;
+
 class State
 {
 public:
@@ -10,17 +20,62 @@ public:
 	virtual ~State() = default;
 
 	virtual void Init() = 0;
+
+	// Called instead of Init when the state is pushed again while its resources are still resident
+	virtual void Reactivate() {}
+
+	// Runs on a worker thread from StateStack::PreloadState, read and decode assets here without touching the GPU.
+	virtual void Preload() {}
+
+	// Runs on the main thread once Preload is done, do a small piece of GPU work per call and return true when finished.
+	virtual bool FinishPreload() { return true; }
 	
 	virtual bool Update() = 0;
-	virtual void Render() = 0;
+
+	// aInterpolationAlpha is how far time has moved past the last Update, as a fraction of a fixed
+	// step. Blend previous and current simulation state with it, it is always 1 without a fixed step.
+	virtual void Render(float aInterpolationAlpha) = 0;
 
 	virtual void ExitState() = 0;
 
 	virtual void Deactivate() = 0;
 
+	// Whether the state below should be rendered too, the result is cached by the StateStack
+	// so call StateStackProxy::InvalidateRenderWindow when it changes.
 	virtual bool LetThroughRender() = 0;
 
+	// Whether the state below keeps being updated while this one is on top. Covered states are updated
+	// on worker threads in parallel with the top state, so their Update may only touch their own data
+	// and the transition requests on StateStackProxy, and its return value is ignored.
+	// Cached like LetThroughRender, call StateStackProxy::InvalidateUpdateWindow when it changes.
+	virtual bool LetThroughUpdate() { return false; }
+
+	// Bytes the state keeps loaded after Init. States returning more than 0 stay resident when popped,
+	// within StateStack::SetResidentBudget, and are brought back with Reactivate instead of Init.
+	// Read when the state is popped.
+	virtual size_t GetResourceFootprint() const { return 0; }
+
+	// Called when a popped state is evicted from the resident budget, release what Init loaded.
+	// The next push runs Init again.
+	virtual void ReleaseResources() {}
+
+	StateID GetID() const { return myID; }
+
 protected:
+	// Per state arena owned by the StateStack or StaticStateStack, it is rewound right after ReleaseResources (or right after
+	// Deactivate for states without a footprint) so anything allocated from it, also containers using
+	// CU::ArenaAllocator, must be released there. Main thread only.
+	CU::LinearAllocator& GetArena() { return *myArena; }
+
 	StateStackProxy& myStateStackProxy;
+
+private:
+	friend class StateStack;
+	template<class... States>
+	friend class StaticStateStack;
+
+	CU::LinearAllocator* myArena = nullptr;
+	StateID myID = StateID();
+	bool myIsResident = false;
 };
 
@@ -0,0 +1,35 @@
+#include "StateEventBus.h"
+
+void StateEventBus::Unsubscribe(StateID aSubscriber)
+{
+	mySubscribers.erase(aSubscriber);
+}
+
+void StateEventBus::Deliver(StateID aSubscriber)
+{
+	// find, not operator[], other states may be delivered to on other threads at the same time
+	auto it = mySubscribers.find(aSubscriber);
+	if (it == mySubscribers.end())
+	{
+		return;
+	}
+
+	Subscriber& subscriber = it->second;
+	for (const PostedEvent& posted : subscriber.myInbox)
+	{
+		for (const Handler& handler : subscriber.myHandlers)
+		{
+			if (handler.myType == posted.myType)
+			{
+				handler.myFunction(posted.myData);
+			}
+		}
+	}
+	subscriber.myInbox.clear();
+}
+
+uint32_t StateEventBus::NextEventType()
+{
+	static std::atomic<uint32_t> nextType = 0;
+	return nextType.fetch_add(1, std::memory_order_relaxed);
+}
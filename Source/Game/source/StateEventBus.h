@@ -0,0 +1,145 @@
+#pragma once
+#include "StateEnum.h"
+
+#include <CommonUtilities/Common/MPSCRingBuffer.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+// Typed messages between states. Post is lock-free and may be called from any thread, the stack moves
+// posted events into the inbox of every subscribed state on the stack once per frame (Collect), and each
+// state's handlers run in a batch right before its Update (Deliver), on the thread that updates it.
+// A covered state gets its events once it is updated again, its inbox holds at most ourMaxInboxSize.
+// Events have to be trivially copyable and at most ourMaxEventSize bytes.
+class StateEventBus
+{
+public:
+	static constexpr size_t ourCapacity = 1024;
+	static constexpr size_t ourMaxEventSize = 48;
+	// Events for a state that is not updated for a long time are dropped past this
+	static constexpr size_t ourMaxInboxSize = ourCapacity;
+
+	// Any thread. Returns false and counts the event as dropped when the buffer is full.
+	template<class Event>
+	bool Post(const Event& aEvent);
+
+	// Main thread outside of Update, for example in Init. aHandler runs on the thread updating aSubscriber.
+	template<class Event>
+	void Subscribe(StateID aSubscriber, std::function<void(const Event&)> aHandler);
+
+	// Main thread outside of Update, removes every handler of aSubscriber
+	void Unsubscribe(StateID aSubscriber);
+
+	// Game thread, before any state updates. Events for subscribers aIsOnStack rejects are dropped,
+	// the others are kept until that state is updated. Events over a full inbox count as dropped.
+	template<class IsOnStack>
+	void Collect(IsOnStack&& aIsOnStack);
+
+	// Runs aSubscriber's handlers for its collected events. States may be delivered to in parallel.
+	void Deliver(StateID aSubscriber);
+
+	size_t GetDroppedCount() const { return myDroppedCount.load(std::memory_order_relaxed); }
+
+private:
+	struct PostedEvent
+	{
+		uint32_t myType;
+		alignas(std::max_align_t) unsigned char myData[ourMaxEventSize];
+	};
+
+	struct Handler
+	{
+		uint32_t myType;
+		std::function<void(const void*)> myFunction;
+	};
+
+	struct Subscriber
+	{
+		std::vector<Handler> myHandlers;
+		std::vector<PostedEvent> myInbox;
+	};
+
+	template<class Event>
+	static uint32_t GetEventType();
+
+	static uint32_t NextEventType();
+
+	CU::MPSCRingBuffer<PostedEvent, ourCapacity> myEvents;
+	std::map<StateID, Subscriber> mySubscribers;
+	std::atomic<size_t> myDroppedCount = 0;
+};
+
+template<class Event>
+inline bool StateEventBus::Post(const Event& aEvent)
+{
+	static_assert(std::is_trivially_copyable_v<Event>, "Events are copied as bytes, they have to be trivially copyable");
+	static_assert(sizeof(Event) <= ourMaxEventSize, "Event is larger than StateEventBus::ourMaxEventSize");
+	static_assert(alignof(Event) <= alignof(std::max_align_t), "Event is over-aligned");
+
+	PostedEvent posted;
+	posted.myType = GetEventType<Event>();
+	std::memcpy(posted.myData, &aEvent, sizeof(Event));
+
+	if (!myEvents.TryPush(posted))
+	{
+		myDroppedCount.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	return true;
+}
+
+template<class Event>
+inline void StateEventBus::Subscribe(StateID aSubscriber, std::function<void(const Event&)> aHandler)
+{
+	mySubscribers[aSubscriber].myHandlers.push_back({ GetEventType<Event>(), [handler = std::move(aHandler)](const void* aData)
+	{
+		handler(*static_cast<const Event*>(aData));
+	} });
+}
+
+template<class IsOnStack>
+inline void StateEventBus::Collect(IsOnStack&& aIsOnStack)
+{
+	PostedEvent posted;
+	while (myEvents.TryPop(posted))
+	{
+		for (auto& subscriber : mySubscribers)
+		{
+			if (!aIsOnStack(subscriber.first))
+			{
+				continue;
+			}
+
+			for (const Handler& handler : subscriber.second.myHandlers)
+			{
+				if (handler.myType != posted.myType)
+				{
+					continue;
+				}
+
+				if (subscriber.second.myInbox.size() < ourMaxInboxSize)
+				{
+					subscriber.second.myInbox.push_back(posted);
+				}
+				else
+				{
+					myDroppedCount.fetch_add(1, std::memory_order_relaxed);
+				}
+				break;
+			}
+		}
+	}
+}
+
+template<class Event>
+inline uint32_t StateEventBus::GetEventType()
+{
+	static const uint32_t type = NextEventType();
+	return type;
+}
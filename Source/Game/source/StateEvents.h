@@ -0,0 +1,9 @@
+#pragma once
+
+// Events states send each other through StateStackProxy::PostEvent, keep them trivially copyable
+
+// Posted by OptionState whenever the player changes a setting
+struct SettingsChangedEvent
+{
+	float myBrightness;
+};
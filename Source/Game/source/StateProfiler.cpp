@@ -0,0 +1,155 @@
+#include "StateProfiler.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace
+{
+	const char* GetCallbackName(StateCallback aCallback)
+	{
+		switch (aCallback)
+		{
+			case StateCallback::Init: return "Init";
+			case StateCallback::Reactivate: return "Reactivate";
+			case StateCallback::Update: return "Update";
+			case StateCallback::Render: return "Render";
+			case StateCallback::ExitState: return "ExitState";
+			case StateCallback::Deactivate: return "Deactivate";
+			default: return "Unknown";
+		}
+	}
+
+	float GetPercentile(std::array<float, StateProfiler::ourWindowSize>& aSamples, size_t aCount, float aPercentile)
+	{
+		size_t rank = static_cast<size_t>(aPercentile * static_cast<float>(aCount - 1) + 0.5f);
+		std::nth_element(aSamples.begin(), aSamples.begin() + rank, aSamples.begin() + aCount);
+		return aSamples[rank];
+	}
+}
+
+void StateProfiler::RegisterState(StateID aID)
+{
+	mySamples[aID];
+}
+
+void StateProfiler::Record(StateID aID, StateCallback aCallback, float aMilliseconds)
+{
+	auto it = mySamples.find(aID);
+	if (!myIsEnabled || it == mySamples.end())
+	{
+		return;
+	}
+
+	SampleWindow& window = it->second[static_cast<size_t>(aCallback)];
+	window.mySamples[window.myNextSample] = aMilliseconds;
+	window.myNextSample = (window.myNextSample + 1) % ourWindowSize;
+	++window.myTotalSamples;
+}
+
+StateTimingStats StateProfiler::GetStats(StateID aID, StateCallback aCallback) const
+{
+	StateTimingStats stats;
+
+	auto it = mySamples.find(aID);
+	if (it == mySamples.end())
+	{
+		return stats;
+	}
+
+	const SampleWindow& window = it->second[static_cast<size_t>(aCallback)];
+	const size_t count = std::min(window.myTotalSamples, ourWindowSize);
+	if (count == 0)
+	{
+		return stats;
+	}
+
+	std::array<float, ourWindowSize> sorted = window.mySamples;
+	float sum = 0.0f;
+	stats.myMinMs = sorted[0];
+	stats.myMaxMs = sorted[0];
+	for (size_t i = 0; i < count; ++i)
+	{
+		sum += sorted[i];
+		stats.myMinMs = std::min(stats.myMinMs, sorted[i]);
+		stats.myMaxMs = std::max(stats.myMaxMs, sorted[i]);
+	}
+
+	stats.mySampleCount = window.myTotalSamples;
+	stats.myLastMs = window.mySamples[(window.myNextSample + ourWindowSize - 1) % ourWindowSize];
+	stats.myAverageMs = sum / static_cast<float>(count);
+	stats.myP95Ms = GetPercentile(sorted, count, 0.95f);
+	stats.myP99Ms = GetPercentile(sorted, count, 0.99f);
+	return stats;
+}
+
+float StateProfiler::GetLastMs(StateID aID, StateCallback aCallback) const
+{
+	auto it = mySamples.find(aID);
+	if (it == mySamples.end())
+	{
+		return 0.0f;
+	}
+
+	const SampleWindow& window = it->second[static_cast<size_t>(aCallback)];
+	if (window.myTotalSamples == 0)
+	{
+		return 0.0f;
+	}
+	return window.mySamples[(window.myNextSample + ourWindowSize - 1) % ourWindowSize];
+}
+
+bool StateProfiler::DumpToCSV(const std::string& aPath) const
+{
+	std::ofstream file(aPath);
+	if (!file)
+	{
+		return false;
+	}
+
+	file << "StateID,Callback,Samples,LastMs,MinMs,AverageMs,P95Ms,P99Ms,MaxMs\n";
+	for (const auto& state : mySamples)
+	{
+		for (size_t callback = 0; callback < static_cast<size_t>(StateCallback::Count); ++callback)
+		{
+			const StateTimingStats stats = GetStats(state.first, static_cast<StateCallback>(callback));
+			if (stats.mySampleCount == 0)
+			{
+				continue;
+			}
+
+			file << static_cast<int>(state.first) << ','
+				<< GetCallbackName(static_cast<StateCallback>(callback)) << ','
+				<< stats.mySampleCount << ','
+				<< stats.myLastMs << ','
+				<< stats.myMinMs << ','
+				<< stats.myAverageMs << ','
+				<< stats.myP95Ms << ','
+				<< stats.myP99Ms << ','
+				<< stats.myMaxMs << '\n';
+		}
+	}
+
+	return static_cast<bool>(file);
+}
+
+void StateProfiler::Reset()
+{
+	for (auto& state : mySamples)
+	{
+		state.second = StateSamples();
+	}
+}
+
+ScopedStateTimer::ScopedStateTimer(StateProfiler& aProfiler, StateID aID, StateCallback aCallback)
+	: myProfiler(aProfiler)
+	, myID(aID)
+	, myCallback(aCallback)
+{
+	myStartPoint = std::chrono::high_resolution_clock::now();
+}
+
+ScopedStateTimer::~ScopedStateTimer()
+{
+	const auto duration = std::chrono::high_resolution_clock::now() - myStartPoint;
+	myProfiler.Record(myID, myCallback, std::chrono::duration<float, std::milli>(duration).count());
+}
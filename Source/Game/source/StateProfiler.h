@@ -0,0 +1,81 @@
+#pragma once
+#include "StateEnum.h"
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <string>
+
+enum class StateCallback
+{
+	Init,
+	Reactivate,
+	Update,
+	Render,
+	ExitState,
+	Deactivate,
+	Count,
+};
+
+struct StateTimingStats
+{
+	size_t mySampleCount = 0;
+	float myLastMs = 0.0f;
+	float myMinMs = 0.0f;
+	float myAverageMs = 0.0f;
+	float myP95Ms = 0.0f;
+	float myP99Ms = 0.0f;
+	float myMaxMs = 0.0f;
+};
+
+// Keeps the most recent timings of every state callback, keyed by StateID.
+// Different states may be recorded from different threads at the same time, but states have to be
+// registered up front and one state's callback must not be recorded from two threads at once.
+class StateProfiler
+{
+public:
+	static constexpr size_t ourWindowSize = 256;
+
+	void RegisterState(StateID aID);
+
+	void Record(StateID aID, StateCallback aCallback, float aMilliseconds);
+
+	// Statistics over the last ourWindowSize samples
+	StateTimingStats GetStats(StateID aID, StateCallback aCallback) const;
+	float GetLastMs(StateID aID, StateCallback aCallback) const;
+
+	// One row per state and callback that has samples, returns false if the file could not be written
+	bool DumpToCSV(const std::string& aPath) const;
+
+	void Reset();
+
+	void SetEnabled(bool aEnabled) { myIsEnabled = aEnabled; }
+	bool IsEnabled() const { return myIsEnabled; }
+
+private:
+	struct SampleWindow
+	{
+		std::array<float, ourWindowSize> mySamples = {};
+		size_t myNextSample = 0;
+		size_t myTotalSamples = 0;
+	};
+
+	using StateSamples = std::array<SampleWindow, static_cast<size_t>(StateCallback::Count)>;
+
+	std::map<StateID, StateSamples> mySamples;
+	bool myIsEnabled = true;
+};
+
+// Times the enclosing scope and records it in the profiler when it ends
+class ScopedStateTimer
+{
+public:
+	ScopedStateTimer(StateProfiler& aProfiler, StateID aID, StateCallback aCallback);
+	~ScopedStateTimer();
+
+private:
+	std::chrono::time_point<std::chrono::high_resolution_clock> myStartPoint;
+	StateProfiler& myProfiler;
+	StateID myID;
+	StateCallback myCallback;
+};
@@ -1,24 +1,321 @@
 #include "StateStack.h"
 
-void StateStack::CreateState(StateID aID, State* aState)
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+void StateStack::CreateState(StateID aID, State* aState, size_t aArenaBlockSize)
 {
 	myCachedStates[aID] = aState;
+	myArenas[aID] = std::make_unique<CU::LinearAllocator>(aArenaBlockSize);
+	aState->myArena = myArenas[aID].get();
+	aState->myID = aID;
+	myProfiler.RegisterState(aID);
 }
 
 void StateStack::PushState(StateID aID)
 {
-	if (GetCurrentState() != nullptr)
+	// An immediate push cannot be held back, a preload still running for aID is finished first
+	if (!IsReady(aID))
 	{
-		GetCurrentState()->ExitState();
+		FinishPreloadNow(aID);
 	}
-	myStates.push_back(myCachedStates[aID]);
-	myCachedStates[aID]->Init();
+	PushPreparedState(aID);
+}
+
+void StateStack::PushPreparedState(StateID aID)
+{
+	if (State* current = GetCurrentState())
+	{
+		ScopedStateTimer timer(myProfiler, current->myID, StateCallback::ExitState);
+		current->ExitState();
+	}
+	State* state = FindState(aID);
+	assert(state && "PushState of a state that was never created with CreateState");
+	myStates.push_back(state);
+
+	auto resident = std::find_if(myResidentStates.begin(), myResidentStates.end(), [state](const ResidentState& aResident) { return aResident.myState == state; });
+	if (resident != myResidentStates.end())
+	{
+		myResidentBytes -= resident->myFootprint;
+		myResidentStates.erase(resident);
+	}
+
+	if (state->myIsResident)
+	{
+		ScopedStateTimer timer(myProfiler, aID, StateCallback::Reactivate);
+		state->Reactivate();
+	}
+	else
+	{
+		ScopedStateTimer timer(myProfiler, aID, StateCallback::Init);
+		state->Init();
+		state->myIsResident = true;
+	}
+	myRenderWindowIsDirty = true;
+	myUpdateWindowIsDirty = true;
 }
 
 void StateStack::Pop()
 {
-	myStates.back()->Deactivate();
+	if (myStates.empty())
+	{
+		return;
+	}
+
+	State* state = myStates.back();
+	{
+		ScopedStateTimer timer(myProfiler, state->myID, StateCallback::Deactivate);
+		state->Deactivate();
+	}
 	myStates.pop_back();
+
+	// A state pushed more than once stays loaded until its last entry is popped
+	if (std::find(myStates.begin(), myStates.end(), state) == myStates.end())
+	{
+		const size_t footprint = state->GetResourceFootprint();
+		if (footprint > 0 && footprint <= myResidentBudget)
+		{
+			myResidentStates.push_back({ state, footprint });
+			myResidentBytes += footprint;
+			EvictResidentStates(myResidentBudget);
+		}
+		else
+		{
+			ReleaseState(state);
+		}
+	}
+	myRenderWindowIsDirty = true;
+	myUpdateWindowIsDirty = true;
+}
+
+void StateStack::SetResidentBudget(size_t aBytes)
+{
+	myResidentBudget = aBytes;
+	EvictResidentStates(myResidentBudget);
+}
+
+void StateStack::ReleaseResidentStates()
+{
+	EvictResidentStates(0);
+}
+
+void StateStack::ReleaseState(State* aState)
+{
+	aState->ReleaseResources();
+	aState->myArena->Reset();
+	if (myEventBus)
+	{
+		// Init subscribes again next time
+		myEventBus->Unsubscribe(aState->myID);
+	}
+	aState->myIsResident = false;
+}
+
+void StateStack::EvictResidentStates(size_t aBudget)
+{
+	// Every resident state has a footprint above 0, so a budget of 0 releases them all
+	size_t evictedCount = 0;
+	while (myResidentBytes > aBudget)
+	{
+		const ResidentState& resident = myResidentStates[evictedCount];
+		myResidentBytes -= resident.myFootprint;
+		ReleaseState(resident.myState);
+		++evictedCount;
+	}
+	myResidentStates.erase(myResidentStates.begin(), myResidentStates.begin() + evictedCount);
+}
+
+void StateStack::RequestPush(StateID aID)
+{
+	myTransitions.Record(StateTransitionType::Push, aID);
+}
+
+void StateStack::RequestPop()
+{
+	myTransitions.Record(StateTransitionType::Pop);
+}
+
+void StateStack::RequestReplace(StateID aID)
+{
+	myTransitions.Record(StateTransitionType::Replace, aID);
+}
+
+void StateStack::RequestPopTo(StateID aID)
+{
+	myTransitions.Record(StateTransitionType::PopTo, aID);
+}
+
+void StateStack::RequestClear()
+{
+	myTransitions.Record(StateTransitionType::Clear);
+}
+
+bool StateStack::ApplyTransitions()
+{
+	// Transitions requested from inside Init or Deactivate end up in next frame's batch
+	myTransitions.TakeAll(myApplyingTransitions);
+	if (myApplyingTransitions.empty())
+	{
+		return false;
+	}
+
+	size_t appliedCount = 0;
+	for (; appliedCount < myApplyingTransitions.size(); ++appliedCount)
+	{
+		const StateTransition& transition = myApplyingTransitions[appliedCount];
+		const bool hasTarget = transition.myType != StateTransitionType::Pop && transition.myType != StateTransitionType::Clear;
+		if (hasTarget && !FindState(transition.myID))
+		{
+			// Requests can come from anywhere, an unknown ID is dropped instead of reaching PushState
+			++myIgnoredTransitionCount;
+			continue;
+		}
+
+		const bool isPushing = transition.myType == StateTransitionType::Push || transition.myType == StateTransitionType::Replace;
+		if (isPushing && !PrepareForPush(transition.myID))
+		{
+			// Keep showing the current state, the rest of the batch waits for the preload
+			myTransitions.PutBack(myApplyingTransitions.begin() + appliedCount, myApplyingTransitions.end());
+			break;
+		}
+
+		switch (transition.myType)
+		{
+			case StateTransitionType::Push:
+			{
+				PushPreparedState(transition.myID);
+			} break;
+
+			case StateTransitionType::Pop:
+			{
+				Pop();
+			} break;
+
+			case StateTransitionType::Replace:
+			{
+				Pop();
+				PushPreparedState(transition.myID);
+			} break;
+
+			case StateTransitionType::PopTo:
+			{
+				State* target = FindState(transition.myID);
+				if (std::find(myStates.begin(), myStates.end(), target) == myStates.end())
+				{
+					break;
+				}
+				while (GetCurrentState() != target)
+				{
+					Pop();
+				}
+			} break;
+
+			case StateTransitionType::Clear:
+			{
+				while (!myStates.empty())
+				{
+					Pop();
+				}
+			} break;
+		}
+	}
+
+	myApplyingTransitions.clear();
+	return appliedCount > 0;
+}
+
+void StateStack::PreloadState(StateID aID)
+{
+	std::lock_guard<std::mutex> lock(myPreloadMutex);
+
+	State* state = myCachedStates.at(aID);
+	if (myPreloads.count(aID) > 0 || state->myIsResident)
+	{
+		return;
+	}
+
+	PreloadJob& job = myPreloads[aID];
+	job.myWorkerTask = myPreloadWorker.Enqueue([state]() { state->Preload(); });
+}
+
+bool StateStack::IsReady(StateID aID) const
+{
+	std::lock_guard<std::mutex> lock(myPreloadMutex);
+	return myPreloads.count(aID) == 0;
+}
+
+void StateStack::UpdatePreloads(double aBudgetSeconds)
+{
+	using Clock = std::chrono::high_resolution_clock;
+	const Clock::time_point start = Clock::now();
+
+	for (auto it = myPreloads.begin(); it != myPreloads.end();)
+	{
+		PreloadJob& job = it->second;
+		if (!job.myIsWorkerDone)
+		{
+			if (job.myWorkerTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				++it;
+				continue;
+			}
+			job.myWorkerTask.get();
+			job.myIsWorkerDone = true;
+		}
+
+		bool isFinished = false;
+		while (!isFinished && std::chrono::duration<double>(Clock::now() - start).count() < aBudgetSeconds)
+		{
+			isFinished = myCachedStates.at(it->first)->FinishPreload();
+		}
+
+		if (isFinished)
+		{
+			it = myPreloads.erase(it);
+		}
+		else
+		{
+			return;
+		}
+	}
+}
+
+bool StateStack::PrepareForPush(StateID aID)
+{
+	if (IsReady(aID))
+	{
+		return true;
+	}
+
+	if (!myWaitForPreloads)
+	{
+		return false;
+	}
+
+	FinishPreloadNow(aID);
+	return true;
+}
+
+void StateStack::FinishPreloadNow(StateID aID)
+{
+	PreloadJob& job = myPreloads[aID];
+	if (!job.myIsWorkerDone)
+	{
+		job.myWorkerTask.get();
+	}
+
+	while (!myCachedStates.at(aID)->FinishPreload())
+	{
+	}
+
+	myPreloads.erase(aID);
+}
+
+State* StateStack::FindState(StateID aID) const
+{
+	auto it = myCachedStates.find(aID);
+	return it != myCachedStates.end() ? it->second : nullptr;
 }
 
 State* StateStack::GetCurrentState()
@@ -31,12 +328,108 @@ State* StateStack::GetCurrentState()
 	return myStates.back();
 }
 
-void StateStack::RenderStateAtIndex(size_t aIndex)
+void StateStack::Update()
 {
-	if (aIndex < 0) // basfallet
+	if (myStates.empty())
+	{
 		return;
-	// Rendera state under
-	if (myStates[aIndex]->LetThroughRender() == true)
-		RenderStateAtIndex(aIndex - 1);
-	myStates[aIndex]->Render();
+	}
+
+	if (myUpdateWindowIsDirty)
+	{
+		UpdateUpdateWindow();
+	}
+
+	if (myEventBus)
+	{
+		// Covered states keep their events until they are updated again, up to the inbox limit
+		myEventBus->Collect([this](StateID aID)
+		{
+			return std::any_of(myStates.begin(), myStates.end(), [aID](const State* aState) { return aState->myID == aID; });
+		});
+	}
+
+	// A state pushed more than once is still updated once per frame, and never at the same time as
+	// itself, so copies of the top state and repeated copies below it are skipped
+	State* topState = myStates.back();
+	myBackgroundStates.clear();
+	for (size_t index = myLowestUpdatedIndex; index + 1 < myStates.size(); ++index)
+	{
+		State* state = myStates[index];
+		if (state == topState || std::find(myBackgroundStates.begin(), myBackgroundStates.end(), state) != myBackgroundStates.end())
+		{
+			continue;
+		}
+		myBackgroundStates.push_back(state);
+		myBackgroundUpdates.push_back(myWorkers.Enqueue([this, state]()
+		{
+			ScopedStateTimer timer(myProfiler, state->myID, StateCallback::Update);
+			if (myEventBus)
+			{
+				myEventBus->Deliver(state->myID);
+			}
+			state->Update();
+		}));
+	}
+
+	bool keepState = true;
+	{
+		ScopedStateTimer timer(myProfiler, topState->myID, StateCallback::Update);
+		if (myEventBus)
+		{
+			myEventBus->Deliver(topState->myID);
+		}
+		keepState = topState->Update();
+	}
+	if (!keepState)
+	{
+		RequestPop();
+	}
+
+	// Join before anything renders or changes the stack
+	for (std::future<void>& backgroundUpdate : myBackgroundUpdates)
+	{
+		backgroundUpdate.get();
+	}
+	myBackgroundUpdates.clear();
+}
+
+void StateStack::Render(float aInterpolationAlpha)
+{
+	if (myRenderWindowIsDirty)
+	{
+		UpdateRenderWindow();
+	}
+
+	for (size_t index = myLowestVisibleIndex; index < myStates.size(); ++index)
+	{
+		State* state = myStates[index];
+		if (myBeforeStateRender)
+		{
+			myBeforeStateRender();
+		}
+
+		ScopedStateTimer timer(myProfiler, state->myID, StateCallback::Render);
+		state->Render(aInterpolationAlpha);
+	}
+}
+
+void StateStack::UpdateRenderWindow()
+{
+	myLowestVisibleIndex = myStates.empty() ? 0 : myStates.size() - 1;
+	while (myLowestVisibleIndex > 0 && myStates[myLowestVisibleIndex]->LetThroughRender())
+	{
+		--myLowestVisibleIndex;
+	}
+	myRenderWindowIsDirty = false;
+}
+
+void StateStack::UpdateUpdateWindow()
+{
+	myLowestUpdatedIndex = myStates.empty() ? 0 : myStates.size() - 1;
+	while (myLowestUpdatedIndex > 0 && myStates[myLowestUpdatedIndex]->LetThroughUpdate())
+	{
+		--myLowestUpdatedIndex;
+	}
+	myUpdateWindowIsDirty = false;
 }
@@ -1,27 +1,161 @@
 #pragma once
 #include "State.h"
 #include "StateEnum.h"
+#include "StateEventBus.h"
+#include "StateTransitionQueue.h"
+#include "StateProfiler.h"
+#include <CommonUtilities/Common/LinearAllocator.h>
+#include <CommonUtilities/Common/ThreadPool.h>
+#include <functional>
+#include <future>
 #include <vector>
 #include <map>
+#include <memory>
+#include <mutex>
 
 class StateStack
 {
 private:
 	std::map<StateID, State*> myCachedStates;
+	std::map<StateID, std::unique_ptr<CU::LinearAllocator>> myArenas;
 
 public:
-	void CreateState(StateID aID, State* aState);
+	// aArenaBlockSize is the initial size of the state's arena, it grows if a state needs more
+	void CreateState(StateID aID, State* aState, size_t aArenaBlockSize = 64 * 1024);
 
+	// Arena statistics, for example GetArena(aID).GetHighWaterMark() to tune aArenaBlockSize
+	const CU::LinearAllocator& GetArena(StateID aID) const { return *myArenas.at(aID); }
+
+	// Immediate stack changes, only call these outside of State::Update.
+	// PushState blocks until a preload of aID started with PreloadState is finished.
 	void PushState(StateID aID);
 	void Pop();
-	
+
+	// Deferred stack changes, recorded now and applied by ApplyTransitions.
+	// A push directly followed by a pop cancels out and never reaches Init.
+	void RequestPush(StateID aID);
+	void RequestPop();
+	void RequestReplace(StateID aID);
+	void RequestPopTo(StateID aID);
+	void RequestClear();
+
+	// Applies all recorded transitions in order, call once per frame at the frame boundary.
+	// Returns true if the stack was changed.
+	bool ApplyTransitions();
+
+	size_t GetPendingTransitionCount() const { return myTransitions.GetCount(); }
+	// Grows with every request, compare two reads to tell whether anything was requested in between
+	uint64_t GetTransitionRequestCount() const { return myTransitions.GetRequestCount(); }
+	// Requests for an ID that was never created with CreateState, ApplyTransitions skips them
+	size_t GetIgnoredTransitionCount() const { return myIgnoredTransitionCount; }
+
+	StateTransitionQueue& GetTransitionQueue() { return myTransitions; }
+
+	// Runs aID's Preload on a worker thread, UpdatePreloads then finishes it on the main thread.
+	void PreloadState(StateID aID);
+
+	// False while a preload of aID is still running, states that were never preloaded are always ready.
+	bool IsReady(StateID aID) const;
+
+	// Calls FinishPreload on states whose worker part is done until aBudgetSeconds has been spent.
+	void UpdatePreloads(double aBudgetSeconds);
+
+	// When false (default) a push of a state that is not ready is held back and the current state keeps
+	// being shown, when true ApplyTransitions blocks until the preload is finished.
+	void SetWaitForPreloads(bool aWaitForPreloads) { myWaitForPreloads = aWaitForPreloads; }
+
+	// Memory that popped states may keep resident, see State::GetResourceFootprint. Least recently
+	// popped states are released first when over budget, 0 releases every state as soon as it is popped.
+	void SetResidentBudget(size_t aBytes);
+	size_t GetResidentBudget() const { return myResidentBudget; }
+
+	// Footprint of the popped states that are currently resident
+	size_t GetResidentBytes() const { return myResidentBytes; }
+
+	// Releases every popped state that is still resident
+	void ReleaseResidentStates();
+
 	size_t size() const { return myStates.size(); };
 
 	State* GetCurrentState();
 
-	void RenderStateAtIndex(size_t aIndex);
+	// Updates the top state, a state returning false from Update is popped at the end of the frame.
+	// States uncovered through LetThroughUpdate are updated on worker threads at the same time and
+	// are all finished when this returns.
+	void Update();
+
+	// Renders the visible states bottom-up, starting at the lowest state that is not covered
+	void Render(float aInterpolationAlpha = 1.0f);
+
+	// Called before each state's Render, for example to start a CustomRenderer group
+	// so the sorted sprites of a state still end up over the states below it
+	void SetBeforeStateRender(std::function<void()> aCallback) { myBeforeStateRender = std::move(aCallback); }
+
+	// Events are collected at the start of Update and delivered to each state right before its Update.
+	// StateStackProxy sets its own bus.
+	void SetEventBus(StateEventBus* aEventBus) { myEventBus = aEventBus; }
+
+	// Timings of every state callback the stack makes
+	StateProfiler& GetProfiler() { return myProfiler; }
+	const StateProfiler& GetProfiler() const { return myProfiler; }
+
+	// Call when a state's LetThroughRender result changes, the stack itself invalidates on push and pop
+	void InvalidateRenderWindow() { myRenderWindowIsDirty = true; }
+
+	// Call when a state's LetThroughUpdate result changes, the stack itself invalidates on push and pop
+	void InvalidateUpdateWindow() { myUpdateWindowIsDirty = true; }
 
 	std::vector<State*> myStates;
 
+private:
+	State* FindState(StateID aID) const;
+	void UpdateRenderWindow();
+	void UpdateUpdateWindow();
+	bool PrepareForPush(StateID aID);
+	void PushPreparedState(StateID aID);
+	void FinishPreloadNow(StateID aID);
+	void ReleaseState(State* aState);
+	void EvictResidentStates(size_t aBudget);
+
+	struct PreloadJob
+	{
+		std::future<void> myWorkerTask;
+		bool myIsWorkerDone = false;
+	};
+
+	StateProfiler myProfiler;
+	// Background state updates, joined every frame
+	CU::ThreadPool myWorkers;
+	// Preloads block on file reads, they get their own thread so the per frame join never waits on them
+	CU::ThreadPool myPreloadWorker{ 1 };
+	std::map<StateID, PreloadJob> myPreloads;
+	mutable std::mutex myPreloadMutex;
+	bool myWaitForPreloads = false;
+
+	std::vector<std::future<void>> myBackgroundUpdates;
+	// States sent to a worker this frame, each distinct state only once
+	std::vector<State*> myBackgroundStates;
+	size_t myLowestUpdatedIndex = 0;
+	bool myUpdateWindowIsDirty = true;
+
+	size_t myLowestVisibleIndex = 0;
+	bool myRenderWindowIsDirty = true;
+	std::function<void()> myBeforeStateRender;
+
+	StateTransitionQueue myTransitions;
+	std::vector<StateTransition> myApplyingTransitions;
+	size_t myIgnoredTransitionCount = 0;
+	StateEventBus* myEventBus = nullptr;
+
+	struct ResidentState
+	{
+		State* myState;
+		size_t myFootprint;
+	};
+
+	// Popped states that kept their resources, least recently popped first
+	std::vector<ResidentState> myResidentStates;
+	size_t myResidentBudget = 256 * 1024 * 1024;
+	size_t myResidentBytes = 0;
 };
 
@@ -1,25 +1,67 @@
-#include "stdafx.h"
-
 #include "StateStackProxy.h"
 
 #include "StateStack.h"
-#include "MenuState.h"
-#include "OptionState.h"
-#include "InGameState.h"
 
-StateStackProxy::StateStackProxy(StateStack& aStateStack) : myStateStack(aStateStack)
+StateStackProxy::StateStackProxy(StateStack& aStateStack) : myStateStack(&aStateStack), myTransitions(aStateStack.GetTransitionQueue())
 {
-	
+	aStateStack.SetEventBus(&myEventBus);
 }
 
-void StateStackProxy::Init()
+StateStackProxy::StateStackProxy(StateTransitionQueue& aTransitionQueue) : myStateStack(nullptr), myTransitions(aTransitionQueue)
 {
-	myStateStack.CreateState(StateID::Menu, new MenuState(*this));
-	myStateStack.CreateState(StateID::Options, new OptionState(*this));
-	myStateStack.CreateState(StateID::InGame, new InGameState(*this));
+
 }
 
 void StateStackProxy::PushState(StateID aID)
 {
-	myStateStack.PushState(aID);
+	myTransitions.Record(StateTransitionType::Push, aID);
+}
+
+void StateStackProxy::PopState()
+{
+	myTransitions.Record(StateTransitionType::Pop);
+}
+
+void StateStackProxy::ReplaceState(StateID aID)
+{
+	myTransitions.Record(StateTransitionType::Replace, aID);
+}
+
+void StateStackProxy::PopToState(StateID aID)
+{
+	myTransitions.Record(StateTransitionType::PopTo, aID);
+}
+
+void StateStackProxy::ClearStates()
+{
+	myTransitions.Record(StateTransitionType::Clear);
+}
+
+void StateStackProxy::PreloadState(StateID aID)
+{
+	if (myStateStack != nullptr)
+	{
+		myStateStack->PreloadState(aID);
+	}
+}
+
+bool StateStackProxy::IsReady(StateID aID) const
+{
+	return myStateStack == nullptr || myStateStack->IsReady(aID);
+}
+
+void StateStackProxy::InvalidateRenderWindow()
+{
+	if (myStateStack != nullptr)
+	{
+		myStateStack->InvalidateRenderWindow();
+	}
+}
+
+void StateStackProxy::InvalidateUpdateWindow()
+{
+	if (myStateStack != nullptr)
+	{
+		myStateStack->InvalidateUpdateWindow();
+	}
 }
@@ -1,18 +1,59 @@
 #pragma once
 #include "StateEnum.h"
+#include "StateEventBus.h"
 
+class CustomRenderer;
 class StateStack;
+class StateTransitionQueue;
 
 class StateStackProxy
 {
 public:
 	explicit StateStackProxy(StateStack& aStateStack);
 
+	// For stacks that only consume transitions, such as StaticStateStack. Preloading is not
+	// available then, states always count as ready and Init does nothing.
+	explicit StateStackProxy(StateTransitionQueue& aTransitionQueue);
+
+	// Creates the game's states, defined in StateStackProxyInit.cpp
 	void Init();
 	
+	// Requests are applied by the StateStack at the end of the frame. These and the preload
+	// functions may be called from covered states that are updated on worker threads.
 	void PushState(StateID aID);
+	void PopState();
+	void ReplaceState(StateID aID);
+	void PopToState(StateID aID);
+	void ClearStates();
+
+	// Starts loading a state's assets in the background so pushing it later does not stall
+	void PreloadState(StateID aID);
+	bool IsReady(StateID aID) const;
+
+	// Call when LetThroughRender starts returning something else
+	void InvalidateRenderWindow();
+
+	// Call when LetThroughUpdate starts returning something else
+	void InvalidateUpdateWindow();
+
+	// Lock-free, may be called from any thread. Subscribers get the event right before their next Update.
+	template<class Event>
+	bool PostEvent(const Event& aEvent) { return myEventBus.Post(aEvent); }
+
+	// Call from the subscriber's Init, the subscription lasts until the stack releases the state
+	template<class Event>
+	void Subscribe(StateID aSubscriber, std::function<void(const Event&)> aHandler) { myEventBus.Subscribe<Event>(aSubscriber, std::move(aHandler)); }
+
+	StateEventBus& GetEventBus() { return myEventBus; }
+
+	// Where states submit their sprites during Render, nullptr makes them draw directly
+	void SetRenderer(CustomRenderer* aRenderer) { myRenderer = aRenderer; }
+	CustomRenderer* GetRenderer() const { return myRenderer; }
 	
 private:
-	StateStack& myStateStack;
+	StateStack* myStateStack;
+	StateTransitionQueue& myTransitions;
+	CustomRenderer* myRenderer = nullptr;
+	StateEventBus myEventBus;
 };
 
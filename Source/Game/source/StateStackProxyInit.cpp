@@ -0,0 +1,21 @@
+#include "stdafx.h"
+
+#include "StateStackProxy.h"
+
+#include "StateStack.h"
+#include "MenuState.h"
+#include "OptionState.h"
+#include "InGameState.h"
+
+// Kept apart from StateStackProxy.cpp so the proxy itself builds without the engine, see StateBench
+void StateStackProxy::Init()
+{
+	if (myStateStack == nullptr)
+	{
+		return;
+	}
+
+	myStateStack->CreateState(StateID::Menu, new MenuState(*this));
+	myStateStack->CreateState(StateID::Options, new OptionState(*this));
+	myStateStack->CreateState(StateID::InGame, new InGameState(*this));
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include "StateEnum.h"
+
+enum class StateTransitionType
+{
+	Push,
+	Pop,
+	Replace,
+	PopTo,
+	Clear,
+};
+
+// A stack change requested during a frame, applied by StateStack::ApplyTransitions.
+// myID is ignored for Pop and Clear.
+struct StateTransition
+{
+	StateTransitionType myType;
+	StateID myID;
+};
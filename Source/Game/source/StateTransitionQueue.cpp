@@ -0,0 +1,95 @@
+#include "StateTransitionQueue.h"
+
+#include <algorithm>
+
+void StateTransitionQueue::Record(StateTransitionType aType, StateID aID)
+{
+	std::lock_guard<std::mutex> lock(myMutex);
+	++myRequestCount;
+
+	StateTransition* last = myTransitions.empty() ? nullptr : &myTransitions.back();
+
+	switch (aType)
+	{
+		case StateTransitionType::Push:
+		{
+			// Requested again while the first push waits for its preload
+			if (IsHeldBackPush(aID))
+			{
+				return;
+			}
+		} break;
+
+		case StateTransitionType::Pop:
+		{
+			// Push then pop of the same state never needs to happen
+			if (last != nullptr && last->myType == StateTransitionType::Push)
+			{
+				myTransitions.pop_back();
+				return;
+			}
+			// Replace is a pop followed by a push, the push cancels against this pop
+			if (last != nullptr && last->myType == StateTransitionType::Replace)
+			{
+				last->myType = StateTransitionType::Pop;
+				return;
+			}
+		} break;
+
+		case StateTransitionType::Replace:
+		{
+			// Replacing a state that was never shown is the same as pushing the new one
+			if (last != nullptr && last->myType == StateTransitionType::Push)
+			{
+				last->myID = aID;
+				return;
+			}
+		} break;
+
+		case StateTransitionType::Clear:
+		{
+			// Nothing recorded before a clear will be visible after it
+			myTransitions.clear();
+		} break;
+
+		default:
+			break;
+	}
+
+	myTransitions.push_back({ aType, aID });
+}
+
+size_t StateTransitionQueue::GetCount() const
+{
+	std::lock_guard<std::mutex> lock(myMutex);
+	return myHeldBackTransitions.size() + myTransitions.size();
+}
+
+uint64_t StateTransitionQueue::GetRequestCount() const
+{
+	std::lock_guard<std::mutex> lock(myMutex);
+	return myRequestCount;
+}
+
+void StateTransitionQueue::TakeAll(std::vector<StateTransition>& aOutTransitions)
+{
+	std::lock_guard<std::mutex> lock(myMutex);
+	aOutTransitions.clear();
+	aOutTransitions.swap(myHeldBackTransitions);
+	aOutTransitions.insert(aOutTransitions.end(), myTransitions.begin(), myTransitions.end());
+	myTransitions.clear();
+}
+
+void StateTransitionQueue::PutBack(std::vector<StateTransition>::const_iterator aBegin, std::vector<StateTransition>::const_iterator aEnd)
+{
+	std::lock_guard<std::mutex> lock(myMutex);
+	myHeldBackTransitions.insert(myHeldBackTransitions.begin(), aBegin, aEnd);
+}
+
+bool StateTransitionQueue::IsHeldBackPush(StateID aID) const
+{
+	return std::any_of(myHeldBackTransitions.begin(), myHeldBackTransitions.end(), [aID](const StateTransition& aTransition)
+	{
+		return (aTransition.myType == StateTransitionType::Push || aTransition.myType == StateTransitionType::Replace) && aTransition.myID == aID;
+	});
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "StateTransition.h"
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Records stack changes requested during a frame, thread safe. Coalesces requests that cancel out,
+// a push directly followed by a pop is dropped before it ever reaches Init. Transitions put back while
+// waiting on a preload are already decided and never coalesce with newer requests.
+class StateTransitionQueue
+{
+public:
+	// Pushing a state again while its held back push waits is dropped
+	void Record(StateTransitionType aType, StateID aID = StateID());
+
+	size_t GetCount() const;
+	// Every Record call so far, including requests that were coalesced or dropped
+	uint64_t GetRequestCount() const;
+
+	// Moves every recorded transition into aOutTransitions, requests made after this go to the next batch
+	void TakeAll(std::vector<StateTransition>& aOutTransitions);
+
+	// Returns transitions that could not be applied yet, they are placed before any newer request
+	void PutBack(std::vector<StateTransition>::const_iterator aBegin, std::vector<StateTransition>::const_iterator aEnd);
+
+private:
+	bool IsHeldBackPush(StateID aID) const;
+
+	// Put back after the last TakeAll, applied before myTransitions
+	std::vector<StateTransition> myHeldBackTransitions;
+	std::vector<StateTransition> myTransitions;
+	uint64_t myRequestCount = 0;
+	mutable std::mutex myMutex;
+};
@@ -0,0 +1,11 @@
+#include "stdafx.h"
+
+#include "StaticStateStack.h"
+
+#include "InGameState.h"
+#include "MenuState.h"
+#include "OptionState.h"
+
+// Nothing in the game runs on a StaticStateStack yet, instantiating it with the game's states here
+// keeps the template compiling against them
+template class StaticStateStack<MenuState, OptionState, InGameState>;
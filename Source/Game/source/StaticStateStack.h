@@ -0,0 +1,340 @@
+#pragma once
+#include "State.h"
+#include "StateStackProxy.h"
+#include "StateTransitionQueue.h"
+#include <CommonUtilities/Common/LinearAllocator.h>
+
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// StateStack where the set of states is known at compile time, for example
+// StaticStateStack<MenuState, OptionState, InGameState>. The states live inline in a tuple and every
+// call goes through a generated switch on the concrete type, so mark the state classes final and the
+// compiler can call and inline them directly. Each state type needs a static constexpr StateID ourID.
+//
+// Transitions behave exactly like in StateStack. Preloading, profiling and the resident budget are
+// StateStack only, so pushing a state that is not on the stack runs Init and popping its last entry
+// runs ReleaseResources and rewinds its arena. Covered states (LetThroughUpdate) are updated on the
+// calling thread before the top state, each distinct state once per frame.
+template<class... States>
+class StaticStateStack
+{
+public:
+	static constexpr size_t ourStateCount = sizeof...(States);
+
+	StaticStateStack();
+	StaticStateStack(const StaticStateStack& aStaticStateStack) = delete;
+	StaticStateStack& operator=(const StaticStateStack& aStaticStateStack) = delete;
+	~StaticStateStack() = default;
+
+	// Slot of aID in the tuple, ourStateCount if no state in this stack has that ID
+	static constexpr size_t GetSlot(StateID aID);
+
+	template<class StateType>
+	StateType& GetState() { return std::get<StateType>(myStates); }
+
+	// The proxy all states were constructed with, its transition requests go to this stack
+	StateStackProxy& GetProxy() { return myProxy; }
+
+	// Arena statistics, see StateStack::GetArena
+	const CU::LinearAllocator& GetArena(StateID aID) const { return myArenas[GetSlot(aID)]; }
+
+	// Immediate stack changes, only call these outside of State::Update.
+	void PushState(StateID aID);
+	void Pop();
+
+	// Applies all transitions requested through the proxy, call once per frame at the frame boundary.
+	// Returns true if the stack was changed.
+	bool ApplyTransitions();
+
+	size_t GetPendingTransitionCount() const { return myTransitions.GetCount(); }
+	// Grows with every request, compare two reads to tell whether anything was requested in between
+	uint64_t GetTransitionRequestCount() const { return myTransitions.GetRequestCount(); }
+
+	// Updates the covered states that are let through and then the top state, a top state
+	// returning false from Update is popped at the end of the frame
+	void Update();
+
+	// Renders the visible states bottom-up
+	void Render(float aInterpolationAlpha = 1.0f);
+
+	size_t size() const { return myStack.size(); }
+
+private:
+	template<class StateType>
+	using ProxyReference = StateStackProxy&;
+
+	template<class Function>
+	void Dispatch(size_t aSlot, Function&& aFunction);
+
+	template<class Function, size_t... Indices>
+	void Dispatch(size_t aSlot, Function& aFunction, std::index_sequence<Indices...>);
+
+	// Gives every state its ID and arena, the way StateStack::CreateState does
+	template<size_t... Indices>
+	void InitSlots(std::index_sequence<Indices...>);
+
+	static constexpr bool HasUniqueIDs();
+
+	StateTransitionQueue myTransitions;
+	StateStackProxy myProxy;
+	std::tuple<States...> myStates;
+	std::array<CU::LinearAllocator, ourStateCount> myArenas;
+
+	std::vector<size_t> myStack;
+	std::vector<StateTransition> myApplyingTransitions;
+};
+
+template<class... States>
+inline StaticStateStack<States...>::StaticStateStack()
+	: myProxy(myTransitions)
+	, myStates(static_cast<ProxyReference<States>>(myProxy)...)
+{
+	static_assert(HasUniqueIDs(), "Every state in a StaticStateStack needs its own ourID");
+
+	InitSlots(std::index_sequence_for<States...>());
+	myStack.reserve(ourStateCount);
+}
+
+template<class... States>
+template<size_t... Indices>
+inline void StaticStateStack<States...>::InitSlots(std::index_sequence<Indices...>)
+{
+	((std::get<Indices>(myStates).myID = std::tuple_element_t<Indices, std::tuple<States...>>::ourID), ...);
+	((std::get<Indices>(myStates).myArena = &myArenas[Indices]), ...);
+}
+
+template<class... States>
+inline constexpr size_t StaticStateStack<States...>::GetSlot(StateID aID)
+{
+	constexpr StateID ids[] = { States::ourID... };
+	for (size_t slot = 0; slot < ourStateCount; ++slot)
+	{
+		if (ids[slot] == aID)
+		{
+			return slot;
+		}
+	}
+	return ourStateCount;
+}
+
+template<class... States>
+inline constexpr bool StaticStateStack<States...>::HasUniqueIDs()
+{
+	constexpr StateID ids[] = { States::ourID... };
+	for (size_t slot = 0; slot < ourStateCount; ++slot)
+	{
+		if (GetSlot(ids[slot]) != slot)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+template<class... States>
+template<class Function>
+inline void StaticStateStack<States...>::Dispatch(size_t aSlot, Function&& aFunction)
+{
+	Dispatch(aSlot, aFunction, std::index_sequence_for<States...>());
+}
+
+template<class... States>
+template<class Function, size_t... Indices>
+inline void StaticStateStack<States...>::Dispatch(size_t aSlot, Function& aFunction, std::index_sequence<Indices...>)
+{
+	// One compare per state type, folded into a switch by the compiler. Each branch sees the
+	// concrete state type so the call is not virtual.
+	(void)((aSlot == Indices && (aFunction(std::get<Indices>(myStates)), true)) || ...);
+}
+
+template<class... States>
+inline void StaticStateStack<States...>::PushState(StateID aID)
+{
+	const size_t slot = GetSlot(aID);
+	if (slot == ourStateCount)
+	{
+		return;
+	}
+
+	if (!myStack.empty())
+	{
+		Dispatch(myStack.back(), [](auto& aState) { aState.ExitState(); });
+	}
+
+	// A state already on the stack keeps what its Init loaded and subscribed
+	const bool isOnStack = std::find(myStack.begin(), myStack.end(), slot) != myStack.end();
+	myStack.push_back(slot);
+	if (isOnStack)
+	{
+		Dispatch(slot, [](auto& aState) { aState.Reactivate(); });
+	}
+	else
+	{
+		Dispatch(slot, [](auto& aState) { aState.Init(); });
+	}
+}
+
+template<class... States>
+inline void StaticStateStack<States...>::Pop()
+{
+	if (myStack.empty())
+	{
+		return;
+	}
+
+	const size_t slot = myStack.back();
+	Dispatch(slot, [](auto& aState) { aState.Deactivate(); });
+	myStack.pop_back();
+
+	// The next push runs Init, which loads and subscribes again
+	if (std::find(myStack.begin(), myStack.end(), slot) == myStack.end())
+	{
+		Dispatch(slot, [this](auto& aState)
+		{
+			aState.ReleaseResources();
+			aState.myArena->Reset();
+			myProxy.GetEventBus().Unsubscribe(aState.ourID);
+		});
+	}
+}
+
+template<class... States>
+inline bool StaticStateStack<States...>::ApplyTransitions()
+{
+	// Transitions requested from inside Init or Deactivate end up in next frame's batch
+	myTransitions.TakeAll(myApplyingTransitions);
+	if (myApplyingTransitions.empty())
+	{
+		return false;
+	}
+
+	for (const StateTransition& transition : myApplyingTransitions)
+	{
+		switch (transition.myType)
+		{
+			case StateTransitionType::Push:
+			{
+				PushState(transition.myID);
+			} break;
+
+			case StateTransitionType::Pop:
+			{
+				Pop();
+			} break;
+
+			case StateTransitionType::Replace:
+			{
+				Pop();
+				PushState(transition.myID);
+			} break;
+
+			case StateTransitionType::PopTo:
+			{
+				const size_t slot = GetSlot(transition.myID);
+				if (std::find(myStack.begin(), myStack.end(), slot) == myStack.end())
+				{
+					break;
+				}
+				while (myStack.back() != slot)
+				{
+					Pop();
+				}
+			} break;
+
+			case StateTransitionType::Clear:
+			{
+				while (!myStack.empty())
+				{
+					Pop();
+				}
+			} break;
+		}
+	}
+
+	myApplyingTransitions.clear();
+	return true;
+}
+
+template<class... States>
+inline void StaticStateStack<States...>::Update()
+{
+	if (myStack.empty())
+	{
+		return;
+	}
+
+	size_t lowestUpdated = myStack.size() - 1;
+	while (lowestUpdated > 0)
+	{
+		bool letThroughUpdate = false;
+		Dispatch(myStack[lowestUpdated], [&letThroughUpdate](auto& aState) { letThroughUpdate = aState.LetThroughUpdate(); });
+		if (!letThroughUpdate)
+		{
+			break;
+		}
+		--lowestUpdated;
+	}
+
+	myProxy.GetEventBus().Collect([this](StateID aID)
+	{
+		return std::find(myStack.begin(), myStack.end(), GetSlot(aID)) != myStack.end();
+	});
+
+	// Like StateStack, a state on the stack more than once is only updated once
+	std::array<bool, ourStateCount> isUpdated = {};
+	isUpdated[myStack.back()] = true;
+	for (size_t index = lowestUpdated; index + 1 < myStack.size(); ++index)
+	{
+		if (isUpdated[myStack[index]])
+		{
+			continue;
+		}
+		isUpdated[myStack[index]] = true;
+		Dispatch(myStack[index], [this](auto& aState)
+		{
+			myProxy.GetEventBus().Deliver(aState.ourID);
+			aState.Update();
+		});
+	}
+
+	bool keepState = true;
+	Dispatch(myStack.back(), [this, &keepState](auto& aState)
+	{
+		myProxy.GetEventBus().Deliver(aState.ourID);
+		keepState = aState.Update();
+	});
+	if (!keepState)
+	{
+		myTransitions.Record(StateTransitionType::Pop);
+	}
+}
+
+template<class... States>
+inline void StaticStateStack<States...>::Render(float aInterpolationAlpha)
+{
+	if (myStack.empty())
+	{
+		return;
+	}
+
+	size_t lowestVisible = myStack.size() - 1;
+	while (lowestVisible > 0)
+	{
+		bool letThroughRender = false;
+		Dispatch(myStack[lowestVisible], [&letThroughRender](auto& aState) { letThroughRender = aState.LetThroughRender(); });
+		if (!letThroughRender)
+		{
+			break;
+		}
+		--lowestVisible;
+	}
+
+	for (size_t index = lowestVisible; index < myStack.size(); ++index)
+	{
+		Dispatch(myStack[index], [aInterpolationAlpha](auto& aState) { aState.Render(aInterpolationAlpha); });
+	}
+}
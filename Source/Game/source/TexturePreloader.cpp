@@ -0,0 +1,64 @@
+#include "stdafx.h"
+
+#include "TexturePreloader.h"
+
+#include <tge/engine.h>
+#include <tge/texture/TextureManager.h>
+
+#include <fstream>
+
+void TexturePreloader::AddTexture(const std::wstring& aTexturePath)
+{
+	myTextures.push_back({ aTexturePath, {} });
+}
+
+void TexturePreloader::ReadFiles()
+{
+	for (PendingTexture& texture : myTextures)
+	{
+		std::ifstream file(Tga::Settings::GetAssetW(texture.myPath), std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			// Left empty, the upload falls back to the regular load which reports the error
+			continue;
+		}
+
+		const std::streamsize size = file.tellg();
+		file.seekg(0, std::ios::beg);
+
+		texture.myData.resize(static_cast<size_t>(size));
+		if (!file.read(reinterpret_cast<char*>(texture.myData.data()), size))
+		{
+			texture.myData.clear();
+		}
+	}
+}
+
+bool TexturePreloader::UploadNext()
+{
+	if (myNextUpload < myTextures.size())
+	{
+		PendingTexture& texture = myTextures[myNextUpload];
+
+		auto& engine = *Tga::Engine::GetInstance();
+		engine.GetTextureManager().GetTextureFromMemory(texture.myPath.c_str(), texture.myData.data(), texture.myData.size());
+
+		texture.myData.clear();
+		texture.myData.shrink_to_fit();
+		++myNextUpload;
+	}
+
+	if (myNextUpload < myTextures.size())
+	{
+		return false;
+	}
+
+	Clear();
+	return true;
+}
+
+void TexturePreloader::Clear()
+{
+	myTextures.clear();
+	myNextUpload = 0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Splits texture loading into a file read that can run on any thread and a
+// GPU upload that runs on the main thread one texture at a time.
+class TexturePreloader
+{
+public:
+	// Same path as later passed to TextureManager::GetTexture, so the upload ends up in its cache.
+	void AddTexture(const std::wstring& aTexturePath);
+
+	// Reads every added texture file into memory, safe to call from a worker thread.
+	void ReadFiles();
+
+	// Uploads the next texture that has been read, returns true once everything is uploaded.
+	bool UploadNext();
+
+	void Clear();
+
+private:
+	struct PendingTexture
+	{
+		std::wstring myPath;
+		std::vector<uint8_t> myData;
+	};
+
+	std::vector<PendingTexture> myTextures;
+	size_t myNextUpload = 0;
+};
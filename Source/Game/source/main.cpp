@@ -2,14 +2,18 @@
 
 #include "GameWorld.h"
 
+#include <tge/drawers/DebugDrawer.h>
+#include <tge/drawers/DebugPerformanceGraph.h>
 #include <tge/drawers/SpriteDrawer.h>
 #include <tge/graphics/GraphicsEngine.h>
+#include <tge/texture/TextureManager.h>
 #include <CommonUtilities/Input.h>
 #include <CommonUtilities/Common/Time.h>
 #include <CommonUtilities/Math/Random.h>
 
 #include "StateStack.h"
 #include "StateStackProxy.h"
+#include "CustomRenderer.h"
 
 void Go(void);
 
@@ -44,6 +48,17 @@ void Go()
 		StateStackProxy stateStackProxy(stateStack);
 		
 		stateStackProxy.Init();
+
+		// Frames the render thread prepares ahead of drawing, overlaps sorting the sprites with the next update.
+		// 0 sorts and draws every frame right away.
+		constexpr unsigned int renderFrameLatency = 1;
+
+		// States submit their sprites here, they are sorted into as few batches as possible at the end of the frame
+		CustomRenderer renderer(renderFrameLatency);
+		// Textures released by a leaving state are still drawn by the frames in flight
+		engine.GetTextureManager().SetReleaseDelay(renderFrameLatency);
+		stateStackProxy.SetRenderer(&renderer);
+		stateStack.SetBeforeStateRender([&renderer]() { renderer.BeginGroup(); });
 		
 		stateStack.PushState(StateID::Menu);
 
@@ -52,23 +67,78 @@ void Go()
 		gameWorld.Init(engine);
 
 		//Tga::SpriteDrawer& spriteDrawer(engine.GetGraphicsEngine().GetSpriteDrawer());
+
+		// Simulation rate in fixed step mode, "fixed_updates_per_second" in the game settings.
+		// 0, the default, runs one variable length Update per rendered frame.
+		const double fixedUpdatesPerSecond = Tga::Settings::GameSettingsNumber("fixed_updates_per_second", 0.0);
+		// Fixed updates allowed per frame before falling behind, keeps a slow frame from snowballing
+		constexpr UINT32 maxFixedUpdatesPerFrame = 5;
+
+		DX::StepTimer stepTimer;
+		if (fixedUpdatesPerSecond > 0.0)
+		{
+			stepTimer.SetFixedTimeStep(true);
+			stepTimer.SetTargetElapsedSeconds(1.0 / fixedUpdatesPerSecond);
+			stepTimer.SetMaxUpdatesPerTick(maxFixedUpdatesPerFrame);
+			CU::Time::SetFixedDeltaTime(1.0 / fixedUpdatesPerSecond);
+		}
+
+#ifndef _RETAIL
+		// Shown together with the FPS graph, F8 writes all state timings to StateTimings.csv
+		Tga::PerformanceGraph stateGraph(&engine.GetDebugDrawer());
+		Tga::Color stateGraphBackgroundColor(0, 0, 1, 0.4f);
+		Tga::Color stateGraphLineColor(1, 1, 1, 1.0f);
+		stateGraph.Init(stateGraphBackgroundColor, stateGraphLineColor, "Top state update + render (us)");
+		stateGraph.SetPosition({ 0.6f, 0.78f });
+#endif
 		
 		while (engine.BeginFrame() && stateStack.size() > 0) {
 			CU::Time::Update();
 
-			bool stateReturnValue = stateStack.GetCurrentState()->Update();
+			bool stateRequestedTransition = false;
+			stepTimer.Tick([&]()
+			{
+				// The stack only changes at the end of the frame, further steps would update a state that is leaving
+				if (stateRequestedTransition)
+				{
+					return;
+				}
+
+				const uint64_t transitionRequestCount = stateStack.GetTransitionRequestCount();
+				stateStack.Update();
+				stateRequestedTransition = stateStack.GetTransitionRequestCount() != transitionRequestCount;
+
+				//gameWorld.Update();
 
-			//gameWorld.Update();
+#ifndef _RETAIL
+				if (CU::Input::GetKeyDown(CU::Keys::F8))
+				{
+					stateStack.GetProfiler().DumpToCSV("StateTimings.csv");
+				}
+#endif
+
+				// Once per update so each key press is seen by exactly one fixed step, even if a frame runs none
+				CU::Input::Update();
+			});
 
-			CU::Input::Update();
 			//gameWorld.Render(spriteDrawer);
 			
-			stateStack.RenderStateAtIndex(stateStack.size() - 1);
+			stateStack.Render(static_cast<float>(stepTimer.GetInterpolationAlpha()));
+			renderer.Flush(engine.GetGraphicsEngine().GetSpriteDrawer());
 
-			if (stateReturnValue == false)
+#ifndef _RETAIL
+			if (State* topState = stateStack.GetCurrentState())
 			{
-				stateStack.Pop();
+				const StateProfiler& profiler = stateStack.GetProfiler();
+				const float topStateMs = profiler.GetLastMs(topState->GetID(), StateCallback::Update) + profiler.GetLastMs(topState->GetID(), StateCallback::Render);
+				stateGraph.FeedValue(static_cast<int>(topStateMs * 1000.0f));
 			}
+			stateGraph.Render();
+#endif
+
+			stateStack.UpdatePreloads(0.002);
+			stateStack.ApplyTransitions();
+
 			engine.EndFrame();
 		}
 	}
@@ -0,0 +1,65 @@
+include "../../Premake/extensions.lua"
+
+workspace "StateBench"
+	location "../../"
+	startproject "StateBench"
+	architecture "x64"
+
+	configurations {
+		"Debug",
+		"Release",
+	}
+
+include "../../Premake/common.lua"
+
+-------------------------------------------------------------
+-- The game's StateStack with mock states and the CPU occlusion culler, no window or device, so it builds on any platform.
+-- Linux: premake5 --file=Source/StateBench/premake5.lua gmake2 && make -C Local config=release
+project "StateBench"
+	location (dirs.projectfiles)
+
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++17"
+
+	debugdir "%{dirs.bin}"
+	targetdir ("%{dirs.bin}")
+	targetname("%{prj.name}_%{cfg.buildcfg}")
+	objdir ("%{dirs.temp}/%{prj.name}/%{cfg.buildcfg}")
+
+	includedirs { dirs.external, path.join(dirs.source, "Game/source") }
+
+	files {
+		"source/**.h",
+		"source/**.cpp",
+		path.join(dirs.source, "Game/source/StateStack.cpp"),
+		path.join(dirs.source, "Game/source/StateStackProxy.cpp"),
+		path.join(dirs.source, "Game/source/StateEventBus.cpp"),
+		path.join(dirs.source, "Game/source/StateProfiler.cpp"),
+		path.join(dirs.source, "Game/source/StateTransitionQueue.cpp"),
+		path.join(dirs.external, "CommonUtilities/Collision/OcclusionCuller.cpp"),
+		path.join(dirs.external, "CommonUtilities/Common/LinearAllocator.cpp"),
+		path.join(dirs.external, "CommonUtilities/Common/ThreadPool.cpp"),
+	}
+
+	filter "configurations:Debug"
+		defines {"_DEBUG"}
+		runtime "Debug"
+		symbols "on"
+	filter "configurations:Release"
+		defines "_RELEASE"
+		runtime "Release"
+		optimize "on"
+
+	filter "system:windows"
+		staticruntime "off"
+		systemversion "latest"
+		warnings "Extra"
+		flags {
+			"FatalCompileWarnings",
+			"MultiProcessorCompile"
+		}
+
+	filter "system:linux"
+		warnings "Extra"
+		links { "pthread" }
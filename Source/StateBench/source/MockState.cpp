@@ -0,0 +1,62 @@
+#include "MockState.h"
+#include "NullRenderer.h"
+
+#include <thread>
+
+MockState::MockState(StateStackProxy& aStateStackProxy, NullRenderer& aRenderer, size_t aFootprint, bool aLetThroughRender, bool aLetThroughUpdate)
+	: State(aStateStackProxy)
+	, myRenderer(aRenderer)
+	, myFootprint(aFootprint)
+	, myLetThroughRender(aLetThroughRender)
+	, myLetThroughUpdate(aLetThroughUpdate)
+{
+}
+
+void MockState::Init()
+{
+	++myInitCount;
+	myHasResources = true;
+	myPreloadCountAtInit = myPreloadCount;
+
+	// Like a real state building its per visit data
+	GetArena().Allocate(1024);
+
+	myStateStackProxy.Subscribe<MockEvent>(GetID(), [this](const MockEvent& /*aEvent*/) { ++myEventCount; });
+}
+
+void MockState::Reactivate()
+{
+	++myReactivateCount;
+}
+
+void MockState::Preload()
+{
+	std::this_thread::sleep_for(myPreloadDuration);
+	++myPreloadCount;
+}
+
+bool MockState::Update()
+{
+	++myUpdateCount;
+	return true;
+}
+
+void MockState::Render(float /*aInterpolationAlpha*/)
+{
+	myRenderer.Draw(GetID());
+}
+
+void MockState::ExitState()
+{
+}
+
+void MockState::Deactivate()
+{
+	++myDeactivateCount;
+}
+
+void MockState::ReleaseResources()
+{
+	++myReleaseCount;
+	myHasResources = false;
+}
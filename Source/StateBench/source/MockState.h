@@ -0,0 +1,127 @@
+#pragma once
+#include <State.h>
+#include <StateStackProxy.h>
+
+#include <CommonUtilities/Common/LinearAllocator.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+class NullRenderer;
+
+// Posted by the bench script every frame
+struct MockEvent
+{
+	size_t myFrame;
+};
+
+// State without assets that counts its callbacks, so the bench can check the stack kept them balanced
+class MockState final :
+	public State
+{
+public:
+	MockState(StateStackProxy& aStateStackProxy, NullRenderer& aRenderer, size_t aFootprint, bool aLetThroughRender, bool aLetThroughUpdate);
+
+	void Init() override;
+	void Reactivate() override;
+
+	// Sleeps for the preload duration, like a state reading its files
+	void Preload() override;
+	void SetPreloadDuration(std::chrono::milliseconds aDuration) { myPreloadDuration = aDuration; }
+
+	bool Update() override;
+	void Render(float aInterpolationAlpha) override;
+
+	void ExitState() override;
+	void Deactivate() override;
+
+	bool LetThroughRender() override { return myLetThroughRender; }
+	bool LetThroughUpdate() override { return myLetThroughUpdate; }
+
+	size_t GetResourceFootprint() const override { return myFootprint; }
+	void ReleaseResources() override;
+
+	// Times the state was entered minus times it was left, equals its number of entries on the stack
+	long long GetEnteredCount() const { return static_cast<long long>(myInitCount + myReactivateCount) - static_cast<long long>(myDeactivateCount); }
+
+	bool HasResources() const { return myHasResources; }
+
+	size_t GetInitCount() const { return myInitCount; }
+	size_t GetReactivateCount() const { return myReactivateCount; }
+	size_t GetReleaseCount() const { return myReleaseCount; }
+	size_t GetUpdateCount() const { return myUpdateCount; }
+	size_t GetEventCount() const { return myEventCount; }
+	// Preloads that had finished when Init last ran, a push has to wait for a running preload
+	size_t GetPreloadCountAtInit() const { return myPreloadCountAtInit; }
+
+private:
+	NullRenderer& myRenderer;
+	size_t myFootprint;
+	bool myLetThroughRender;
+	bool myLetThroughUpdate;
+	std::chrono::milliseconds myPreloadDuration = std::chrono::milliseconds(0);
+
+	bool myHasResources = false;
+	size_t myInitCount = 0;
+	size_t myReactivateCount = 0;
+	size_t myDeactivateCount = 0;
+	size_t myReleaseCount = 0;
+	size_t myUpdateCount = 0;
+	size_t myEventCount = 0;
+	std::atomic<size_t> myPreloadCount = 0;
+	size_t myPreloadCountAtInit = 0;
+};
+
+// Stands in for one of the game's states in a StaticStateStack, which constructs its states from the
+// proxy alone. Has the game state's ID and LetThroughRender and counts its callbacks like MockState.
+template<StateID ID, bool LetThroughRenderValue>
+class StaticMockState final :
+	public State
+{
+public:
+	static constexpr StateID ourID = ID;
+
+	using State::State;
+
+	void Init() override
+	{
+		++myInitCount;
+		myHasResources = true;
+		GetArena().Allocate(1024);
+		myStateStackProxy.Subscribe<MockEvent>(GetID(), [this](const MockEvent& /*aEvent*/) { ++myEventCount; });
+	}
+
+	void Reactivate() override { ++myReactivateCount; }
+
+	bool Update() override
+	{
+		++myUpdateCount;
+		return true;
+	}
+
+	void Render(float /*aInterpolationAlpha*/) override {}
+	void ExitState() override {}
+	void Deactivate() override { ++myDeactivateCount; }
+
+	bool LetThroughRender() override { return LetThroughRenderValue; }
+
+	void ReleaseResources() override { myHasResources = false; }
+
+	long long GetEnteredCount() const { return static_cast<long long>(myInitCount + myReactivateCount) - static_cast<long long>(myDeactivateCount); }
+	bool HasResources() const { return myHasResources; }
+	size_t GetUpdateCount() const { return myUpdateCount; }
+	size_t GetEventCount() const { return myEventCount; }
+
+private:
+	bool myHasResources = false;
+	size_t myInitCount = 0;
+	size_t myReactivateCount = 0;
+	size_t myDeactivateCount = 0;
+	size_t myUpdateCount = 0;
+	size_t myEventCount = 0;
+};
+
+using StaticMenuState = StaticMockState<StateID::Menu, false>;
+using StaticOptionState = StaticMockState<StateID::Options, true>;
+using StaticInGameState = StaticMockState<StateID::InGame, false>;
@@ -0,0 +1,16 @@
+#pragma once
+#include <StateEnum.h>
+
+#include <cstddef>
+
+// Stands in for the sprite renderer, draws only get counted
+class NullRenderer
+{
+public:
+	void Draw(StateID /*aID*/) { ++myDrawCount; }
+
+	size_t GetDrawCount() const { return myDrawCount; }
+
+private:
+	size_t myDrawCount = 0;
+};
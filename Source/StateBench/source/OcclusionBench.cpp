@@ -0,0 +1,141 @@
+#include "OcclusionBench.h"
+
+#include <CommonUtilities/Collision/OcclusionCuller.h>
+#include <CommonUtilities/Common/ThreadPool.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+	constexpr float ourNear = 0.1f;
+	constexpr float ourFar = 1000.0f;
+
+	// Camera at the origin looking down +z, 90 degrees vertically, depth 0 at the near plane
+	CU::Matrix4x4f CreateProjection(float aAspectRatio)
+	{
+		CU::Matrix4x4f projection;
+		projection(1, 1) = 1.0f / aAspectRatio;
+		projection(2, 2) = 1.0f;
+		projection(3, 3) = ourFar / (ourFar - ourNear);
+		projection(3, 4) = 1.0f;
+		projection(4, 3) = -ourNear * ourFar / (ourFar - ourNear);
+		projection(4, 4) = 0.0f;
+		return projection;
+	}
+
+	CU::Matrix4x4f CreateTranslation(float aX, float aY, float aZ)
+	{
+		CU::Matrix4x4f translation;
+		translation(4, 1) = aX;
+		translation(4, 2) = aY;
+		translation(4, 3) = aZ;
+		return translation;
+	}
+
+	// A square facing the camera, aHalfSize from its center in x and y
+	void AddWall(std::vector<CU::Vector3f>& aPositions, std::vector<uint32_t>& aIndices, float aHalfSize)
+	{
+		aPositions = {
+			CU::Vector3f(-aHalfSize, -aHalfSize, 0.0f),
+			CU::Vector3f(aHalfSize, -aHalfSize, 0.0f),
+			CU::Vector3f(aHalfSize, aHalfSize, 0.0f),
+			CU::Vector3f(-aHalfSize, aHalfSize, 0.0f),
+		};
+		aIndices = { 0, 1, 2, 0, 2, 3 };
+	}
+
+	bool CheckVisibility(const CU::OcclusionCuller& aCuller, const char* aName, const CU::Vector3f& aCenter, bool aExpectVisible)
+	{
+		const bool isVisible = aCuller.IsVisible(CU::Matrix4x4f(), aCenter, CU::Vector3f(1.0f, 1.0f, 1.0f));
+		if (isVisible != aExpectVisible)
+		{
+			printf("Occlusion: the box %s is %s, expected %s\n", aName, isVisible ? "visible" : "hidden", aExpectVisible ? "visible" : "hidden");
+			return false;
+		}
+		return true;
+	}
+
+	bool RunWallScenario(CU::OcclusionCuller& aCuller)
+	{
+		std::vector<CU::Vector3f> positions;
+		std::vector<uint32_t> indices;
+		AddWall(positions, indices, 5.0f);
+
+		aCuller.BeginFrame(CreateProjection(static_cast<float>(aCuller.GetWidth()) / static_cast<float>(aCuller.GetHeight())));
+		aCuller.AddOccluder(CreateTranslation(0.0f, 0.0f, 10.0f), positions, indices);
+		aCuller.EndFrame();
+
+		// The wall's shadow at z = 20 reaches 10 to each side
+		return CheckVisibility(aCuller, "behind the wall", CU::Vector3f(0.0f, 0.0f, 20.0f), false)
+			&& CheckVisibility(aCuller, "beside the wall", CU::Vector3f(20.0f, 0.0f, 20.0f), true)
+			&& CheckVisibility(aCuller, "reaching past the wall's edge", CU::Vector3f(10.5f, 0.0f, 20.0f), true)
+			&& CheckVisibility(aCuller, "in front of the wall", CU::Vector3f(0.0f, 0.0f, 5.0f), true)
+			&& CheckVisibility(aCuller, "off screen", CU::Vector3f(0.0f, 100.0f, 20.0f), false);
+	}
+}
+
+bool RunOcclusionBench(unsigned int aSeed)
+{
+	CU::ThreadPool threadPool;
+	CU::OcclusionCuller culler(&threadPool);
+	if (!RunWallScenario(culler))
+	{
+		return false;
+	}
+
+	// Wall segments scattered in front of a field of boxes, like a street seen from one end
+	constexpr size_t wallCount = 200;
+	constexpr size_t boxCount = 20000;
+	constexpr size_t frameCount = 100;
+
+	std::mt19937 random(aSeed);
+	std::uniform_real_distribution<float> sideDistribution(-60.0f, 60.0f);
+	std::uniform_real_distribution<float> wallDepthDistribution(5.0f, 40.0f);
+	std::uniform_real_distribution<float> boxDepthDistribution(5.0f, 200.0f);
+
+	std::vector<CU::Vector3f> positions;
+	std::vector<uint32_t> indices;
+	AddWall(positions, indices, 4.0f);
+	std::vector<CU::Matrix4x4f> walls;
+	for (size_t index = 0; index < wallCount; ++index)
+	{
+		walls.push_back(CreateTranslation(sideDistribution(random), sideDistribution(random) * 0.25f, wallDepthDistribution(random)));
+	}
+	std::vector<CU::Vector3f> boxes;
+	for (size_t index = 0; index < boxCount; ++index)
+	{
+		boxes.emplace_back(sideDistribution(random) * 2.0f, sideDistribution(random) * 0.5f, boxDepthDistribution(random));
+	}
+
+	using Clock = std::chrono::high_resolution_clock;
+	const CU::Matrix4x4f projection = CreateProjection(static_cast<float>(culler.GetWidth()) / static_cast<float>(culler.GetHeight()));
+	const CU::Matrix4x4f identity;
+	const CU::Vector3f extents(1.0f, 1.0f, 1.0f);
+	std::vector<uint32_t> visible;
+	double rasterizeSeconds = 0.0;
+	double cullSeconds = 0.0;
+	for (size_t frame = 0; frame < frameCount; ++frame)
+	{
+		const Clock::time_point start = Clock::now();
+		culler.BeginFrame(projection);
+		for (const CU::Matrix4x4f& wall : walls)
+		{
+			culler.AddOccluder(wall, positions, indices);
+		}
+		culler.EndFrame();
+		const Clock::time_point rasterized = Clock::now();
+		culler.Cull(boxes.size(), [&](size_t aIndex) { return culler.IsVisible(identity, boxes[aIndex], extents); }, visible);
+		const Clock::time_point culled = Clock::now();
+
+		rasterizeSeconds += std::chrono::duration<double>(rasterized - start).count();
+		cullSeconds += std::chrono::duration<double>(culled - rasterized).count();
+	}
+
+	printf("%-24s %zu walls rasterized in %.3f ms, %zu boxes tested in %.3f ms, %zu visible (%u x %u, %u threads)\n", "Occlusion culling",
+		wallCount, rasterizeSeconds * 1000.0 / frameCount, boxCount, cullSeconds * 1000.0 / frameCount, visible.size(),
+		culler.GetWidth(), culler.GetHeight(), threadPool.GetThreadCount());
+	return true;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// CU::OcclusionCuller without the engine: a wall has to hide the box behind it and not the ones beside
+// or in front of it, then a scene of wall segments and boxes is timed. Returns false on a wrong result.
+bool RunOcclusionBench(unsigned int aSeed);
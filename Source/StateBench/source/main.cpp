@@ -0,0 +1,573 @@
+#include "MockState.h"
+#include "NullRenderer.h"
+#include "OcclusionBench.h"
+
+#include <StateStack.h>
+#include <StateStackProxy.h>
+#include <StaticStateStack.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Scripted push/pop/replace soak of StateStack without a window or device. Reports how long applying
+// transitions takes, the stack's own cost per frame and heap allocations, and returns 1 as soon as the
+// stack loses track of a state. The CPU occlusion culler is checked and timed after it, see OcclusionBench.h.
+// Usage: StateBench [frames] [seed]
+
+namespace
+{
+	std::atomic<size_t> ourAllocationCount = 0;
+
+	constexpr size_t ourStateCount = 8;
+	constexpr size_t ourMaxDepth = 6;
+	constexpr size_t ourResidentBudget = 3 * 1024 * 1024;
+
+	struct Timings
+	{
+		std::vector<float> mySamples;
+
+		void Add(std::chrono::high_resolution_clock::duration aDuration)
+		{
+			mySamples.push_back(std::chrono::duration<float, std::micro>(aDuration).count());
+		}
+
+		void Print(const char* aName)
+		{
+			if (mySamples.empty())
+			{
+				printf("%-24s no samples\n", aName);
+				return;
+			}
+
+			double total = 0.0;
+			for (float sample : mySamples)
+			{
+				total += sample;
+			}
+
+			const size_t p50 = mySamples.size() / 2;
+			const size_t p99 = mySamples.size() * 99 / 100;
+			std::nth_element(mySamples.begin(), mySamples.begin() + p50, mySamples.end());
+			const float median = mySamples[p50];
+			std::nth_element(mySamples.begin(), mySamples.begin() + p99, mySamples.end());
+			const float percentile99 = mySamples[p99];
+			const float max = *std::max_element(mySamples.begin(), mySamples.end());
+
+			printf("%-24s avg %8.3f us  p50 %8.3f us  p99 %8.3f us  max %9.3f us  (%zu samples)\n",
+				aName, total / static_cast<double>(mySamples.size()), median, percentile99, max, mySamples.size());
+		}
+	};
+
+	StateID GetStateID(size_t aIndex)
+	{
+		return static_cast<StateID>(aIndex);
+	}
+
+	// States are destroyed before their stack, a preload still running on the worker would use a freed state
+	void WaitForPreloads(StateStack& aStateStack, size_t aFirstIndex, size_t aCount)
+	{
+		for (size_t index = aFirstIndex; index < aFirstIndex + aCount; ++index)
+		{
+			while (!aStateStack.IsReady(GetStateID(index)))
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				aStateStack.UpdatePreloads(1.0);
+			}
+		}
+	}
+
+	// What a state would request during its Update, picked at random but reproducible from the seed
+	void RequestScriptedTransition(std::mt19937& aRandom, StateStackProxy& aProxy, size_t aDepth, size_t aStateCount = ourStateCount)
+	{
+		std::uniform_int_distribution<size_t> stateDistribution(0, aStateCount - 1);
+		std::uniform_int_distribution<int> actionDistribution(0, 99);
+
+		const int action = actionDistribution(aRandom);
+		const StateID id = GetStateID(stateDistribution(aRandom));
+
+		if (aDepth <= 1 && action < 40)
+		{
+			aProxy.PushState(id);
+		}
+		else if (action < 20 && aDepth < ourMaxDepth)
+		{
+			aProxy.PushState(id);
+		}
+		else if (action < 40)
+		{
+			aProxy.PopState();
+		}
+		else if (action < 50)
+		{
+			aProxy.ReplaceState(id);
+		}
+		else if (action < 52)
+		{
+			aProxy.PopToState(id);
+		}
+		else if (action < 53)
+		{
+			aProxy.ClearStates();
+			aProxy.PushState(id);
+		}
+		else if (action < 56)
+		{
+			aProxy.PreloadState(id);
+		}
+	}
+
+	// The same state on the stack more than once, also right below and above itself, under see-through
+	// states. Every distinct state has to be updated and delivered its events exactly once per frame.
+	bool RunRepeatedStateScenario(NullRenderer& aRenderer)
+	{
+		constexpr size_t frameCount = 1000;
+
+		StateStack stateStack;
+		StateStackProxy stateStackProxy(stateStack);
+		MockState repeated(stateStackProxy, aRenderer, 0, false, true);
+		MockState other(stateStackProxy, aRenderer, 0, false, true);
+		stateStack.CreateState(GetStateID(0), &repeated);
+		stateStack.CreateState(GetStateID(1), &other);
+
+		stateStack.PushState(GetStateID(0));
+		stateStack.PushState(GetStateID(0));
+		stateStack.PushState(GetStateID(1));
+		stateStack.PushState(GetStateID(0));
+
+		for (size_t frame = 0; frame < frameCount; ++frame)
+		{
+			stateStackProxy.PostEvent(MockEvent{ frame });
+			stateStack.Update();
+		}
+
+		const bool isUpdatedOnce = repeated.GetUpdateCount() == frameCount && other.GetUpdateCount() == frameCount;
+		const bool isDeliveredOnce = repeated.GetEventCount() == frameCount && other.GetEventCount() == frameCount;
+		if (!isUpdatedOnce || !isDeliveredOnce)
+		{
+			printf("Repeated state: %zu updates and %zu events, the other state %zu updates and %zu events, expected %zu of each\n",
+				repeated.GetUpdateCount(), repeated.GetEventCount(), other.GetUpdateCount(), other.GetEventCount(), frameCount);
+			return false;
+		}
+
+		stateStack.RequestClear();
+		stateStack.ApplyTransitions();
+		return true;
+	}
+
+	// Requests for an ID that was never created are skipped, the stack must not push a null state or grow
+	bool RunUnknownStateScenario(NullRenderer& aRenderer)
+	{
+		StateStack stateStack;
+		StateStackProxy stateStackProxy(stateStack);
+		MockState known(stateStackProxy, aRenderer, 0, false, false);
+		stateStack.CreateState(GetStateID(0), &known);
+		stateStack.PushState(GetStateID(0));
+
+		const StateID unknownID = GetStateID(ourStateCount);
+		stateStack.RequestPopTo(unknownID);
+		stateStack.RequestReplace(unknownID);
+		stateStack.RequestPush(unknownID);
+		stateStack.ApplyTransitions();
+
+		if (stateStack.size() != 1 || stateStack.GetCurrentState() != &known || stateStack.GetIgnoredTransitionCount() != 3)
+		{
+			printf("Unknown state: stack of %zu with %zu ignored requests, expected the known state alone and 3 ignored\n",
+				stateStack.size(), stateStack.GetIgnoredTransitionCount());
+			return false;
+		}
+
+		stateStack.RequestClear();
+		stateStack.ApplyTransitions();
+		return true;
+	}
+
+	// An immediate push of a state that is still preloading finishes the preload before Init
+	bool RunPushWhilePreloadingScenario(NullRenderer& aRenderer)
+	{
+		StateStack stateStack;
+		StateStackProxy stateStackProxy(stateStack);
+		MockState preloaded(stateStackProxy, aRenderer, 0, false, false);
+		preloaded.SetPreloadDuration(std::chrono::milliseconds(30));
+		stateStack.CreateState(GetStateID(0), &preloaded);
+
+		stateStack.PreloadState(GetStateID(0));
+		stateStack.PushState(GetStateID(0));
+
+		const bool isReady = stateStack.IsReady(GetStateID(0));
+		WaitForPreloads(stateStack, 0, 1);
+		if (preloaded.GetPreloadCountAtInit() != 1 || !isReady)
+		{
+			printf("Push while preloading: Init ran after %zu preloads and the preload is %s, expected 1 and finished\n",
+				preloaded.GetPreloadCountAtInit(), isReady ? "finished" : "still pending");
+			return false;
+		}
+
+		stateStack.RequestClear();
+		stateStack.ApplyTransitions();
+		return true;
+	}
+
+	// Preloads sleeping like slow file reads must not hold up the frame, which joins the background updates
+	bool RunSlowPreloadScenario(NullRenderer& aRenderer)
+	{
+		constexpr size_t preloadCount = 8;
+		constexpr std::chrono::milliseconds preloadDuration(50);
+		constexpr size_t frameCount = 20;
+
+		StateStack stateStack;
+		StateStackProxy stateStackProxy(stateStack);
+		MockState background(stateStackProxy, aRenderer, 0, false, false);
+		MockState top(stateStackProxy, aRenderer, 0, false, true);
+		stateStack.CreateState(GetStateID(0), &background);
+		stateStack.CreateState(GetStateID(1), &top);
+		std::vector<std::unique_ptr<MockState>> preloaded;
+		for (size_t index = 0; index < preloadCount; ++index)
+		{
+			preloaded.push_back(std::make_unique<MockState>(stateStackProxy, aRenderer, 0, false, false));
+			preloaded.back()->SetPreloadDuration(preloadDuration);
+			stateStack.CreateState(GetStateID(2 + index), preloaded.back().get());
+		}
+		stateStack.PushState(GetStateID(0));
+		stateStack.PushState(GetStateID(1));
+
+		for (size_t index = 0; index < preloadCount; ++index)
+		{
+			stateStack.PreloadState(GetStateID(2 + index));
+		}
+
+		using Clock = std::chrono::high_resolution_clock;
+		Clock::duration slowestFrame = Clock::duration::zero();
+		for (size_t frame = 0; frame < frameCount; ++frame)
+		{
+			const Clock::time_point frameStart = Clock::now();
+			stateStack.Update();
+			slowestFrame = std::max(slowestFrame, Clock::now() - frameStart);
+		}
+
+		WaitForPreloads(stateStack, 2, preloadCount);
+
+		if (background.GetUpdateCount() != frameCount || slowestFrame >= preloadDuration / 2)
+		{
+			printf("Slow preloads: %zu background updates and the slowest frame took %.3f ms, expected %zu and under %.3f ms\n",
+				background.GetUpdateCount(), std::chrono::duration<double, std::milli>(slowestFrame).count(), frameCount,
+				std::chrono::duration<double, std::milli>(preloadDuration / 2).count());
+			return false;
+		}
+		return true;
+	}
+
+	// A covered state is not updated, it gets the events posted meanwhile once it is uncovered.
+	// Its inbox stops growing at StateEventBus::ourMaxInboxSize, the rest count as dropped.
+	bool RunCoveredStateScenario(NullRenderer& aRenderer)
+	{
+		constexpr size_t overflowCount = 100;
+		constexpr size_t frameCount = StateEventBus::ourMaxInboxSize + overflowCount;
+
+		StateStack stateStack;
+		StateStackProxy stateStackProxy(stateStack);
+		MockState covered(stateStackProxy, aRenderer, 0, false, false);
+		MockState top(stateStackProxy, aRenderer, 0, false, false);
+		stateStack.CreateState(GetStateID(0), &covered);
+		stateStack.CreateState(GetStateID(1), &top);
+		stateStack.PushState(GetStateID(0));
+		stateStack.PushState(GetStateID(1));
+
+		for (size_t frame = 0; frame < frameCount; ++frame)
+		{
+			stateStackProxy.PostEvent(MockEvent{ frame });
+			stateStack.Update();
+		}
+		const size_t coveredEventCount = covered.GetEventCount();
+		stateStack.RequestPop();
+		stateStack.ApplyTransitions();
+		stateStack.Update();
+
+		const size_t droppedCount = stateStackProxy.GetEventBus().GetDroppedCount();
+		if (coveredEventCount != 0 || covered.GetEventCount() != StateEventBus::ourMaxInboxSize || top.GetEventCount() != frameCount || droppedCount != overflowCount)
+		{
+			printf("Covered state: %zu events while covered and %zu once uncovered, %zu to the top state and %zu dropped, expected 0, %zu, %zu and %zu\n",
+				coveredEventCount, covered.GetEventCount(), top.GetEventCount(), droppedCount, StateEventBus::ourMaxInboxSize, frameCount, overflowCount);
+			return false;
+		}
+
+		stateStack.RequestClear();
+		stateStack.ApplyTransitions();
+		return true;
+	}
+
+	// A push held back by a preload is already decided: a pop requested while it waits comes after it,
+	// and pushing the same state again while it waits does not stack a second copy
+	bool RunHeldBackPushScenario(NullRenderer& aRenderer)
+	{
+		constexpr size_t maxFrameCount = 1000;
+
+		StateStack stateStack;
+		StateStackProxy stateStackProxy(stateStack);
+		MockState bottom(stateStackProxy, aRenderer, 0, false, false);
+		MockState preloaded(stateStackProxy, aRenderer, 0, false, false);
+		stateStack.CreateState(GetStateID(0), &bottom);
+		stateStack.CreateState(GetStateID(1), &preloaded);
+		stateStack.PushState(GetStateID(0));
+
+		stateStack.PreloadState(GetStateID(1));
+		stateStack.RequestPush(GetStateID(1));
+		stateStack.ApplyTransitions();
+		stateStack.RequestPush(GetStateID(1));
+		stateStack.RequestPop();
+		for (size_t frame = 0; frame < maxFrameCount && stateStack.GetPendingTransitionCount() > 0; ++frame)
+		{
+			// Gives the worker time to run the preload
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			stateStack.UpdatePreloads(1.0);
+			stateStack.ApplyTransitions();
+		}
+
+		if (stateStack.size() != 1 || preloaded.GetInitCount() != 1 || preloaded.GetEnteredCount() != 0)
+		{
+			printf("Held back push: %zu states on the stack and the preloaded state initialized %zu times, expected 1 and 1\n",
+				stateStack.size(), preloaded.GetInitCount());
+			return false;
+		}
+
+		stateStack.RequestClear();
+		stateStack.ApplyTransitions();
+		return true;
+	}
+
+	using BenchStaticStateStack = StaticStateStack<StaticMenuState, StaticOptionState, StaticInGameState>;
+
+	template<class StateType>
+	bool CheckStaticState(const BenchStaticStateStack& aStateStack, const StateType& aState, size_t aFrame)
+	{
+		if (aState.GetID() != StateType::ourID)
+		{
+			printf("Static frame %zu: state %d reports the ID %d\n", aFrame, static_cast<int>(StateType::ourID), static_cast<int>(aState.GetID()));
+			return false;
+		}
+		if (aState.GetEnteredCount() > 0 && (!aState.HasResources() || aStateStack.GetArena(StateType::ourID).GetUsedBytes() == 0))
+		{
+			printf("Static frame %zu: state %d is on the stack without its resources or arena allocation\n", aFrame, static_cast<int>(StateType::ourID));
+			return false;
+		}
+		return true;
+	}
+
+	// The game's three states in a StaticStateStack, which has to give them their IDs and arenas
+	// like StateStack does, and file their subscriptions under their own IDs
+	bool RunStaticStackScenario(std::mt19937& aRandom)
+	{
+		constexpr size_t frameCount = 10000;
+
+		auto stateStack = std::make_unique<BenchStaticStateStack>();
+		StateStackProxy& proxy = stateStack->GetProxy();
+		const StaticMenuState& menu = stateStack->GetState<StaticMenuState>();
+		const StaticOptionState& options = stateStack->GetState<StaticOptionState>();
+		const StaticInGameState& inGame = stateStack->GetState<StaticInGameState>();
+
+		stateStack->PushState(StateID::Menu);
+		stateStack->PushState(StateID::InGame);
+		proxy.PostEvent(MockEvent{ 0 });
+		stateStack->Update();
+		if (menu.GetEventCount() != 0 || inGame.GetEventCount() != 1)
+		{
+			printf("Static stack: the event reached the menu %zu times and the game %zu times, expected 0 and 1\n", menu.GetEventCount(), inGame.GetEventCount());
+			return false;
+		}
+
+		for (size_t frame = 0; frame < frameCount; ++frame)
+		{
+			RequestScriptedTransition(aRandom, proxy, stateStack->size(), BenchStaticStateStack::ourStateCount);
+			proxy.PostEvent(MockEvent{ frame });
+			stateStack->Update();
+			stateStack->Render();
+			stateStack->ApplyTransitions();
+			if (stateStack->size() == 0)
+			{
+				stateStack->PushState(StateID::Menu);
+			}
+
+			const long long enteredCount = menu.GetEnteredCount() + options.GetEnteredCount() + inGame.GetEnteredCount();
+			if (enteredCount != static_cast<long long>(stateStack->size()))
+			{
+				printf("Static frame %zu: states entered %lld times but the stack holds %zu\n", frame, enteredCount, stateStack->size());
+				return false;
+			}
+			if (!CheckStaticState(*stateStack, menu, frame) || !CheckStaticState(*stateStack, options, frame) || !CheckStaticState(*stateStack, inGame, frame))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool CheckStack(const StateStack& aStateStack, const std::vector<std::unique_ptr<MockState>>& aStates, size_t aFrame)
+	{
+		for (const std::unique_ptr<MockState>& state : aStates)
+		{
+			const long long stackCount = std::count(aStateStack.myStates.begin(), aStateStack.myStates.end(), state.get());
+			if (state->GetEnteredCount() != stackCount)
+			{
+				printf("Frame %zu: state %d entered %lld times but is on the stack %lld times\n", aFrame, static_cast<int>(state->GetID()), state->GetEnteredCount(), stackCount);
+				return false;
+			}
+			if (stackCount > 0 && !state->HasResources())
+			{
+				printf("Frame %zu: state %d is on the stack without its resources\n", aFrame, static_cast<int>(state->GetID()));
+				return false;
+			}
+		}
+
+		if (aStateStack.GetResidentBytes() > aStateStack.GetResidentBudget())
+		{
+			printf("Frame %zu: %zu resident bytes over the budget of %zu\n", aFrame, aStateStack.GetResidentBytes(), aStateStack.GetResidentBudget());
+			return false;
+		}
+		return true;
+	}
+}
+
+void* operator new(size_t aSize)
+{
+	++ourAllocationCount;
+	if (void* memory = std::malloc(aSize == 0 ? 1 : aSize))
+	{
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* aMemory) noexcept
+{
+	std::free(aMemory);
+}
+
+void operator delete(void* aMemory, size_t /*aSize*/) noexcept
+{
+	std::free(aMemory);
+}
+
+int main(const int argc, const char* argv[])
+{
+	const size_t frameCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+	const unsigned int seed = argc > 2 ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10)) : 1;
+
+	NullRenderer renderer;
+	if (!RunRepeatedStateScenario(renderer) || !RunUnknownStateScenario(renderer) || !RunPushWhilePreloadingScenario(renderer) || !RunSlowPreloadScenario(renderer) || !RunCoveredStateScenario(renderer) || !RunHeldBackPushScenario(renderer))
+	{
+		return 1;
+	}
+
+	std::mt19937 staticRandom(seed);
+	if (!RunStaticStackScenario(staticRandom))
+	{
+		return 1;
+	}
+
+	StateStack stateStack;
+	StateStackProxy stateStackProxy(stateStack);
+	stateStack.SetResidentBudget(ourResidentBudget);
+
+	// A mix of opaque and see-through states, half of them stay resident when popped
+	std::vector<std::unique_ptr<MockState>> states;
+	for (size_t index = 0; index < ourStateCount; ++index)
+	{
+		const size_t footprint = index % 2 == 0 ? (index + 1) * 256 * 1024 : 0;
+		states.push_back(std::make_unique<MockState>(stateStackProxy, renderer, footprint, index % 3 == 1, index % 4 == 3));
+		stateStack.CreateState(GetStateID(index), states.back().get(), 4 * 1024);
+	}
+
+	std::mt19937 random(seed);
+	stateStack.PushState(GetStateID(0));
+
+	Timings frameTimings;
+	Timings applyTimings;
+	frameTimings.mySamples.reserve(frameCount);
+	applyTimings.mySamples.reserve(frameCount);
+
+	using Clock = std::chrono::high_resolution_clock;
+	size_t appliedFrameCount = 0;
+	size_t heldBackFrameCount = 0;
+	size_t steadyAllocationCount = 0;
+	const size_t warmupFrameCount = std::min<size_t>(frameCount / 10, 10000);
+	const size_t startAllocationCount = ourAllocationCount;
+	const Clock::time_point runStart = Clock::now();
+
+	for (size_t frame = 0; frame < frameCount; ++frame)
+	{
+		if (frame == warmupFrameCount)
+		{
+			steadyAllocationCount = ourAllocationCount;
+		}
+
+		RequestScriptedTransition(random, stateStackProxy, stateStack.size());
+		stateStackProxy.PostEvent(MockEvent{ frame });
+
+		const Clock::time_point frameStart = Clock::now();
+		stateStack.Update();
+		stateStack.Render();
+		frameTimings.Add(Clock::now() - frameStart);
+
+		stateStack.UpdatePreloads(0.001);
+
+		const Clock::time_point applyStart = Clock::now();
+		const bool isApplied = stateStack.ApplyTransitions();
+		const Clock::time_point applyEnd = Clock::now();
+		if (isApplied)
+		{
+			applyTimings.Add(applyEnd - applyStart);
+			++appliedFrameCount;
+		}
+		if (stateStack.GetPendingTransitionCount() > 0)
+		{
+			++heldBackFrameCount;
+		}
+
+		if (stateStack.size() == 0)
+		{
+			stateStack.PushState(GetStateID(0));
+		}
+
+		if (!CheckStack(stateStack, states, frame))
+		{
+			WaitForPreloads(stateStack, 0, ourStateCount);
+			return 1;
+		}
+	}
+
+	const double runSeconds = std::chrono::duration<double>(Clock::now() - runStart).count();
+	const size_t allocationCount = ourAllocationCount - startAllocationCount;
+	const size_t steadyFrameCount = frameCount - warmupFrameCount;
+	steadyAllocationCount = ourAllocationCount - steadyAllocationCount;
+
+	size_t initCount = 0;
+	size_t reactivateCount = 0;
+	size_t releaseCount = 0;
+	size_t eventCount = 0;
+	for (const std::unique_ptr<MockState>& state : states)
+	{
+		initCount += state->GetInitCount();
+		reactivateCount += state->GetReactivateCount();
+		releaseCount += state->GetReleaseCount();
+		eventCount += state->GetEventCount();
+	}
+
+	printf("StateBench: %zu frames, seed %u, %.2f s, %zu draws\n", frameCount, seed, runSeconds, renderer.GetDrawCount());
+	frameTimings.Print("Update + Render");
+	applyTimings.Print("ApplyTransitions");
+	printf("%-24s %zu frames applied, %zu frames held back by preloads\n", "Transitions", appliedFrameCount, heldBackFrameCount);
+	printf("%-24s %zu Init, %zu Reactivate, %zu ReleaseResources\n", "State callbacks", initCount, reactivateCount, releaseCount);
+	printf("%-24s %zu delivered, %zu dropped\n", "Events", eventCount, stateStackProxy.GetEventBus().GetDroppedCount());
+	printf("%-24s %zu total, %.3f per frame after %zu warmup frames\n", "Allocations", allocationCount,
+		steadyFrameCount > 0 ? static_cast<double>(steadyAllocationCount) / static_cast<double>(steadyFrameCount) : 0.0, warmupFrameCount);
+
+	WaitForPreloads(stateStack, 0, ourStateCount);
+	return RunOcclusionBench(seed) ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+#!/bin/sh
+# Headless StateStack bench, see Source/StateBench. Builds into Bin/StateBench_Release.
+set -e
+mkdir -p Bin/settings Bin/Shaders Lib Local Temp
+Premake/premake5 --file=Source/StateBench/premake5.lua gmake2
+make -C Local config=release